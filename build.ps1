@@ -24,7 +24,7 @@ Write-Host "Attempting compilation..." -ForegroundColor Yellow
 
 # Method 1: Try with freeglut
 Write-Host "`nMethod 1: Trying with freeglut..." -ForegroundColor Gray
-$output = & g++ -o build/cosmic_observatory.exe src/main.cpp -lfreeglut -lopengl32 -lglu32 -std=c++11 -O2 2>&1
+$output = & g++ -o build/cosmic_observatory.exe src/main.cpp src/utils/transform.cpp src/utils/camera.cpp -lfreeglut -lopengl32 -lglu32 -std=c++14 -O2 2>&1
 if ($LASTEXITCODE -eq 0) {
     Write-Host "✅ Build successful with freeglut!" -ForegroundColor Green
     Write-Host "`nExecutable: .\build\cosmic_observatory.exe" -ForegroundColor Cyan
@@ -34,7 +34,7 @@ if ($LASTEXITCODE -eq 0) {
 
 # Method 2: Try with glut32
 Write-Host "`nMethod 2: Trying with glut32..." -ForegroundColor Gray
-$output = & g++ -o build/cosmic_observatory.exe src/main.cpp -lglut32 -lopengl32 -lglu32 -std=c++11 -O2 2>&1
+$output = & g++ -o build/cosmic_observatory.exe src/main.cpp src/utils/transform.cpp src/utils/camera.cpp -lglut32 -lopengl32 -lglu32 -std=c++14 -O2 2>&1
 if ($LASTEXITCODE -eq 0) {
     Write-Host "✅ Build successful with glut32!" -ForegroundColor Green
     Write-Host "`nExecutable: .\build\cosmic_observatory.exe" -ForegroundColor Cyan
@@ -44,7 +44,7 @@ if ($LASTEXITCODE -eq 0) {
 
 # Method 3: Try with glut
 Write-Host "`nMethod 3: Trying with glut..." -ForegroundColor Gray
-$output = & g++ -o build/cosmic_observatory.exe src/main.cpp -lglut -lopengl32 -lglu32 -std=c++11 -O2 2>&1
+$output = & g++ -o build/cosmic_observatory.exe src/main.cpp src/utils/transform.cpp src/utils/camera.cpp -lglut -lopengl32 -lglu32 -std=c++14 -O2 2>&1
 if ($LASTEXITCODE -eq 0) {
     Write-Host "✅ Build successful with glut!" -ForegroundColor Green
     Write-Host "`nExecutable: .\build\cosmic_observatory.exe" -ForegroundColor Cyan
@@ -60,7 +60,7 @@ Write-Host "   pacman -S mingw-w64-x86_64-freeglut" -ForegroundColor Gray
 Write-Host "`n2. Or download from:" -ForegroundColor White
 Write-Host "   https://www.transmissionzero.co.uk/software/freeglut-devel/" -ForegroundColor Gray
 Write-Host "`n3. Specify library path manually:" -ForegroundColor White
-Write-Host "   g++ -o build/cosmic_observatory.exe src/main.cpp -L`"C:\path\to\lib`" -lfreeglut -lopengl32 -lglu32 -std=c++11 -O2" -ForegroundColor Gray
+Write-Host "   g++ -o build/cosmic_observatory.exe src/main.cpp src/utils/transform.cpp src/utils/camera.cpp -L`"C:\path\to\lib`" -lfreeglut -lopengl32 -lglu32 -std=c++14 -O2" -ForegroundColor Gray
 Write-Host "`n4. See COMPILATION_GUIDE.md for detailed instructions`n" -ForegroundColor White
 
 exit 1
@@ -1,13 +1,9 @@
-#include <GL/glut.h>
+#include "raster_gl.h"
 
 void drawGrid(int size) {
     glColor3f(0.5f, 0.5f, 0.5f);
     glBegin(GL_LINES);
-    for (int i = -size; i <= size; i++) {
-        glVertex2f(i, -size);
-        glVertex2f(i, size);
-        glVertex2f(-size, i);
-        glVertex2f(size, i);
-    }
+    raster::ImmediateSink sink;
+    raster::grid(size, 1, sink);
     glEnd();
 }
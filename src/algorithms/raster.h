@@ -0,0 +1,569 @@
+// ======================
+// Raster Algorithms
+// ======================
+// Header-only line (Bresenham and Xiaolin Wu), circle, ellipse and grid
+// rasterisers, templated on where the output goes. A sink is any type with
+//
+//   void point(int x, int y);                     // one pixel
+//   void segment(int x0, int y0, int x1, int y1); // a whole line (grid)
+//   void coverage(int x, int y, int weight);      // partial pixel, 1..255
+//                                                 // (wuLine only)
+//
+// Ready-made sinks: PointListSink (vector of points), SpanListSink (line
+// runs, see LineSpan), CoverageListSink (weighted points), FramebufferSink
+// (CPU pixels). GL sinks live next to
+// the GL code that owns the vertices (FloorPlaneSink in scene_cache.h, the
+// immediate-mode wrappers in the .cpp files of this directory).
+//
+// Pixel order is part of the contract: every sink sees the pixels in the
+// order the original per-pixel loops produced them.
+//
+// line(), circle(), ellipse() and orbit() are constexpr (C++14), so a sink
+// with constexpr members can bake fixed shapes at compile time (see
+// utils/baked_overlays.h).
+
+#ifndef COSMIC_RASTER_H
+#define COSMIC_RASTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// One run of pixels: (x, y), then length - 1 more steps along the axis
+struct LineSpan {
+    int16_t x, y;
+    uint16_t length;
+    uint8_t vertical;   // 0: run advances x, 1: run advances y
+    int8_t step;        // +1 / -1 along the run axis
+};
+
+struct LineSegment {
+    int x0, y0, x1, y1;
+
+    bool operator==(const LineSegment& o) const {
+        return x0 == o.x0 && y0 == o.y0 && x1 == o.x1 && y1 == o.y1;
+    }
+};
+
+namespace raster {
+
+struct Point {
+    int x, y;
+    constexpr bool operator==(const Point& o) const { return x == o.x && y == o.y; }
+};
+
+constexpr int iabs(int v) { return v < 0 ? -v : v; }   // std::abs is not constexpr
+
+// ----------------------
+// Bresenham line - per pixel
+// ----------------------
+template <typename Sink>
+constexpr void line(int x0, int y0, int x1, int y1, Sink& sink) {
+    int dx = iabs(x1 - x0);
+    int dy = iabs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+
+    while (true) {
+        sink.point(x0, y0);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 > -dy) { err -= dy; x0 += sx; }
+        if (e2 < dx) { err += dx; y0 += sy; }
+    }
+}
+
+// ----------------------
+// Bresenham line - spans
+// ----------------------
+inline void setSpan(LineSpan& s, int x, int y, int length, bool vertical, int step) {
+    s.x = (int16_t)x;
+    s.y = (int16_t)y;
+    s.length = (uint16_t)length;
+    s.vertical = (uint8_t)vertical;
+    s.step = (int8_t)step;
+}
+
+// Run-slice form of line(), resumable: (x, y, err) is the state line() has
+// on reaching (x, y) and (xe, ye) the last pixel wanted. A run ends where the
+// per-pixel loop takes its minor-axis step, so the output has exactly
+// (minor distance + 1) spans and they are written in one block.
+inline void spanKernel(int x, int y, int err, int xe, int ye, int dx, int dy, int sx, int sy,
+                       std::vector<LineSpan>& out) {
+    size_t base = out.size();
+    out.resize(base + (dx >= dy ? std::abs(ye - y) : std::abs(xe - x)) + 1);
+    LineSpan* o = &out[base];
+
+    if (dx >= dy) {
+        // Row runs are dx / dy long give or take one: start from that guess
+        int q = dy > 0 ? dx / dy : 0;
+        while (y != ye) {
+            int left = std::abs(xe - x);
+            // x-only steps while 2 * err >= dx; each lowers err by dy
+            int k = std::max(q - 1, 0);
+            if (k > 0 && 2 * (err - (k - 1) * dy) < dx) k = 0;
+            while (2 * (err - k * dy) >= dx) k++;
+            k = std::min(k, left);
+            setSpan(*o++, x, y, k + 1, false, sx);
+            x += k * sx;
+            err -= k * dy;
+
+            int e2 = 2 * err;                    // the step that changes row
+            if (e2 > -dy) { err -= dy; x += sx; }
+            if (e2 < dx) { err += dx; y += sy; }
+        }
+        setSpan(*o, x, y, std::abs(xe - x) + 1, false, sx);   // last row runs to the end
+    } else {
+        int q = dx > 0 ? dy / dx : 0;
+        while (x != xe) {
+            int left = std::abs(ye - y);
+            // y-only steps while 2 * err <= -dy; each raises err by dx
+            int k = std::max(q - 1, 0);
+            if (k > 0 && 2 * (err + (k - 1) * dx) > -dy) k = 0;
+            while (2 * (err + k * dx) <= -dy) k++;
+            k = std::min(k, left);
+            setSpan(*o++, x, y, k + 1, true, sy);
+            y += k * sy;
+            err += k * dx;
+
+            int e2 = 2 * err;
+            if (e2 > -dy) { err -= dy; x += sx; }
+            if (e2 < dx) { err += dx; y += sy; }
+        }
+        setSpan(*o, x, y, std::abs(ye - y) + 1, true, sy);
+    }
+}
+
+inline void lineSpans(int x0, int y0, int x1, int y1, std::vector<LineSpan>& out) {
+    int dx = std::abs(x1 - x0);
+    int dy = std::abs(y1 - y0);
+    spanKernel(x0, y0, dx - dy, x1, y1, dx, dy, x0 < x1 ? 1 : -1, y0 < y1 ? 1 : -1, out);
+}
+
+// ----------------------
+// Clipped Bresenham line
+// ----------------------
+// Inclusive pixel rectangle
+struct ClipRect {
+    int xmin, ymin, xmax, ymax;
+
+    constexpr bool contains(int x, int y) const {
+        return x >= xmin && x <= xmax && y >= ymin && y <= ymax;
+    }
+};
+
+// line() state after k steps. The major axis advances every step and the
+// minor axis has stepped m = floor((2 * minor * k + major - 1) / (2 * major))
+// times, which fixes the error term too, so the loop can start anywhere.
+struct LineState {
+    int x, y, err;
+};
+
+inline LineState lineStateAt(int x0, int y0, int dx, int dy, int sx, int sy, long long k) {
+    LineState s;
+    if (dx >= dy) {
+        long long m = dx > 0 ? (2 * (long long)dy * k + dx - 1) / (2 * (long long)dx) : 0;
+        s.x = x0 + (int)(sx * k);
+        s.y = y0 + (int)(sy * m);
+        s.err = (int)(dx - dy - k * dy + m * dx);
+    } else {
+        long long m = (2 * (long long)dx * k + dy - 1) / (2 * (long long)dy);
+        s.x = x0 + (int)(sx * m);
+        s.y = y0 + (int)(sy * k);
+        s.err = (int)(dx - dy + k * dx - m * dy);
+    }
+    return s;
+}
+
+// Steps [k0, k1] of line(x0, y0, x1, y1) whose pixels fall inside `clip`;
+// false when none do. Liang-Barsky on the ideal segment against the rect
+// grown by one pixel (Bresenham strays at most half a pixel) brackets the
+// range; since pixels move monotonically along both axes the in-rect steps
+// are contiguous, and the exact ends are found from lineStateAt.
+inline bool clipLineSteps(int x0, int y0, int x1, int y1, const ClipRect& clip,
+                          long long& k0, long long& k1) {
+    double fx = x1 - x0, fy = y1 - y0;
+    double p[4] = {-fx, fx, -fy, fy};
+    double q[4] = {x0 - (clip.xmin - 1.0), (clip.xmax + 1.0) - x0,
+                   y0 - (clip.ymin - 1.0), (clip.ymax + 1.0) - y0};
+    double t0 = 0, t1 = 1;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            if (q[i] < 0) return false;
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0) t0 = std::max(t0, t);
+            else t1 = std::min(t1, t);
+        }
+    }
+    if (t0 > t1) return false;
+
+    int dx = std::abs(x1 - x0), dy = std::abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    long long n = std::max(dx, dy);
+    k0 = std::max(0LL, (long long)(t0 * n) - 1);
+    k1 = std::min(n, (long long)(t1 * n) + 2);
+    for (; k0 <= k1; k0++) {
+        LineState s = lineStateAt(x0, y0, dx, dy, sx, sy, k0);
+        if (clip.contains(s.x, s.y)) break;
+    }
+    for (; k1 >= k0; k1--) {
+        LineState s = lineStateAt(x0, y0, dx, dy, sx, sy, k1);
+        if (clip.contains(s.x, s.y)) break;
+    }
+    return k0 <= k1;
+}
+
+// The pixels of line() inside `clip`, in line() order, without walking
+// the clipped-away steps
+template <typename Sink>
+inline void clippedLine(int x0, int y0, int x1, int y1, const ClipRect& clip, Sink& sink) {
+    long long k0, k1;
+    if (!clipLineSteps(x0, y0, x1, y1, clip, k0, k1)) return;
+    int dx = std::abs(x1 - x0), dy = std::abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    LineState s = lineStateAt(x0, y0, dx, dy, sx, sy, k0);
+    for (long long k = k0; k <= k1; k++) {
+        sink.point(s.x, s.y);
+        int e2 = 2 * s.err;
+        if (e2 > -dy) { s.err -= dy; s.x += sx; }
+        if (e2 < dx) { s.err += dx; s.y += sy; }
+    }
+}
+
+// Spans of the clipped line
+inline void clippedLineSpans(int x0, int y0, int x1, int y1, const ClipRect& clip,
+                             std::vector<LineSpan>& out) {
+    long long k0, k1;
+    if (!clipLineSteps(x0, y0, x1, y1, clip, k0, k1)) return;
+    int dx = std::abs(x1 - x0), dy = std::abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    LineState s = lineStateAt(x0, y0, dx, dy, sx, sy, k0);
+    LineState e = lineStateAt(x0, y0, dx, dy, sx, sy, k1);
+    spanKernel(s.x, s.y, s.err, e.x, e.y, dx, dy, sx, sy, out);
+}
+
+// Expand spans to pixels, in line order
+template <typename Sink>
+inline void spanPixels(const LineSpan* spans, size_t count, Sink& sink) {
+    for (size_t i = 0; i < count; i++) {
+        const LineSpan& s = spans[i];
+        int x = s.x, y = s.y;
+        if (s.vertical) {
+            for (int n = 0; n < s.length; n++, y += s.step) sink.point(x, y);
+        } else {
+            for (int n = 0; n < s.length; n++, x += s.step) sink.point(x, y);
+        }
+    }
+}
+
+inline size_t spanPixelCount(const LineSpan* spans, size_t count) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) n += spans[i].length;
+    return n;
+}
+
+// ----------------------
+// Xiaolin Wu anti-aliased line
+// ----------------------
+// Walks the major axis like line() and splits each step between the two
+// pixels straddling the ideal line, weighted by distance. The minor
+// position is 32.32 fixed point, so long lines end exactly on (x1, y1);
+// endpoints are integral and come out at full weight. Zero weights are
+// skipped, so axis-aligned and diagonal lines match line() pixel for pixel.
+template <typename Sink>
+constexpr void wuLine(int x0, int y0, int x1, int y1, Sink& sink) {
+    bool steep = iabs(y1 - y0) > iabs(x1 - x0);
+    int major0 = steep ? y0 : x0, major1 = steep ? y1 : x1;
+    int minor0 = steep ? x0 : y0, minor1 = steep ? x1 : y1;
+    int n = iabs(major1 - major0);
+    int step = major0 < major1 ? 1 : -1;
+
+    long long gradient = n > 0 ? ((long long)(minor1 - minor0) << 32) / n : 0;
+    long long inter = (long long)minor0 << 32;
+    int major = major0;
+    for (int i = 0; i <= n; i++, major += step, inter += gradient) {
+        // floor and fraction without relying on >> of negatives
+        long long whole = inter >= 0 ? inter >> 32 : -((-inter + 0xFFFFFFFFLL) >> 32);
+        int frac = (int)((inter - (whole << 32)) >> 24);   // 0..255
+        int m = (int)whole;
+        int near = 255 - frac;
+        if (steep) {
+            if (near) sink.coverage(m, major, near);
+            if (frac) sink.coverage(m + 1, major, frac);
+        } else {
+            if (near) sink.coverage(major, m, near);
+            if (frac) sink.coverage(major, m + 1, frac);
+        }
+    }
+}
+
+// ----------------------
+// Midpoint circle - 8-way symmetry
+// ----------------------
+template <typename Sink>
+constexpr void circle(int xc, int yc, int r, Sink& sink) {
+    int x = 0, y = r;
+    int d = 1 - r;
+
+    while (x <= y) {
+        sink.point(xc + x, yc + y);
+        sink.point(xc - x, yc + y);
+        sink.point(xc + x, yc - y);
+        sink.point(xc - x, yc - y);
+        sink.point(xc + y, yc + x);
+        sink.point(xc - y, yc + x);
+        sink.point(xc + y, yc - x);
+        sink.point(xc - y, yc - x);
+
+        if (d < 0) {
+            d += 2 * x + 3;
+        } else {
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
+}
+
+// ----------------------
+// Midpoint ellipse - one quadrant
+// ----------------------
+// Offsets (x, y) from (0, ry) to (rx, 0) in midpoint order, each step moving
+// to an 8-neighbour. Decision variables are scaled by 4 to stay integral and
+// are 64-bit, so radii up to ~30000 are exact.
+template <typename Sink>
+constexpr void ellipseQuadrant(int rx, int ry, Sink& sink) {
+    long long rx2 = (long long)rx * rx, ry2 = (long long)ry * ry;
+    int x = 0, y = ry;
+
+    // Region 1: slope above -1, x steps every pixel
+    long long d = 4 * ry2 - 4 * rx2 * ry + rx2;
+    while (ry2 * x < rx2 * y) {
+        sink.point(x, y);
+        if (d < 0) {
+            d += 4 * ry2 * (2 * x + 3);
+        } else {
+            d += 4 * ry2 * (2 * x + 3) + 4 * rx2 * (2 - 2 * y);
+            y--;
+        }
+        x++;
+    }
+
+    // Region 2: y steps every pixel
+    int last = x;
+    d = ry2 * (2 * x + 1) * (2 * x + 1) + 4 * rx2 * (y - 1) * (y - 1) - 4 * rx2 * ry2;
+    while (y >= 0) {
+        sink.point(x, y);
+        last = x;
+        if (d > 0) {
+            d += 4 * rx2 * (3 - 2 * y);
+        } else {
+            d += 4 * ry2 * (2 * x + 2) + 4 * rx2 * (3 - 2 * y);
+            x++;
+        }
+        y--;
+    }
+    // Very flat ellipses leave region 2 short of the tip
+    for (int tx = last + 1; tx <= rx; tx++) sink.point(tx, 0);
+}
+
+// ----------------------
+// Midpoint ellipse - 4-way symmetry
+// ----------------------
+template <typename Sink>
+struct QuadMirrorSink {
+    Sink& sink;
+    int xc, yc;
+
+    constexpr void point(int x, int y) {
+        sink.point(xc + x, yc + y);
+        sink.point(xc - x, yc + y);
+        sink.point(xc + x, yc - y);
+        sink.point(xc - x, yc - y);
+    }
+};
+
+// Axis-aligned ellipse with semi-axes rx (along x) and ry (along y)
+template <typename Sink>
+constexpr void ellipse(int xc, int yc, int rx, int ry, Sink& sink) {
+    QuadMirrorSink<Sink> mirror{sink, xc, yc};
+    ellipseQuadrant(rx, ry, mirror);
+}
+
+// ----------------------
+// Orbits - rotated ellipse with a focus at (xf, yf)
+// ----------------------
+// cos / sin of the periapsis direction in 2.14 fixed point
+struct Rotation {
+    int c, s;
+};
+
+constexpr Rotation kNoRotation{1 << 14, 0};
+
+// Rounds v / 2^14 half away from zero, so mirrored offsets stay mirrored
+constexpr int fixedRound(long long v) {
+    return v >= 0 ? (int)((v + (1 << 13)) >> 14) : -(int)((-v + (1 << 13)) >> 14);
+}
+
+// Drops the first pixel of a line (already drawn as the previous point)
+template <typename Sink>
+struct TailSink {
+    Sink& sink;
+    bool skip;
+
+    constexpr void point(int x, int y) {
+        if (skip) skip = false;
+        else sink.point(x, y);
+    }
+};
+
+// One quadrant chain of an orbit: mirror, shift the centre off the focus,
+// rotate, round to pixels and join consecutive pixels so rotation leaves
+// no gaps (neighbours directly, anything further with a line).
+template <typename Sink>
+struct OrbitChainSink {
+    Sink& sink;
+    int xf, yf, c;
+    Rotation rot;
+    int mx, my;
+    bool skipFirst;
+    bool started;
+    int px, py;
+
+    constexpr void point(int x, int y) {
+        long long X = (long long)mx * x - c, Y = (long long)my * y;
+        int qx = xf + fixedRound(X * rot.c - Y * rot.s);
+        int qy = yf + fixedRound(X * rot.s + Y * rot.c);
+        if (!started) {
+            started = true;
+            if (!skipFirst) sink.point(qx, qy);
+        } else if (iabs(qx - px) <= 1 && iabs(qy - py) <= 1) {
+            if (qx != px || qy != py) sink.point(qx, qy);
+        } else {
+            TailSink<Sink> tail{sink, true};
+            line(px, py, qx, qy, tail);
+        }
+        px = qx;
+        py = qy;
+    }
+};
+
+// Ellipse with semi-axes a >= b, focal distance c (= a * e), one focus at
+// (xf, yf) and periapsis towards `rot`. Pixels come out as four connected
+// chains, each from the minor-axis vertex to a major-axis vertex; with
+// c = 0 and kNoRotation they are exactly the ellipse() quadrants. Rotated,
+// rounding adds up to sqrt(2) / 2 pixel to the midpoint error
+// (--bench-ellipses measures both).
+template <typename Sink>
+constexpr void orbit(int xf, int yf, int a, int b, int c, Rotation rot, Sink& sink) {
+    const int mirrors[4][2] = {{1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+    for (int q = 0; q < 4; q++) {
+        // chains 2 and 4 start on the vertex chains 1 and 3 already drew
+        OrbitChainSink<Sink> chain{sink, xf, yf, c, rot, mirrors[q][0], mirrors[q][1],
+                                   q % 2 == 1, false, 0, 0};
+        ellipseQuadrant(a, b, chain);
+    }
+}
+
+// ----------------------
+// Square grid of lines, -size..size every `step`
+// ----------------------
+template <typename Sink>
+inline void grid(int size, int step, Sink& sink) {
+    for (int i = -size; i <= size; i += step) {
+        sink.segment(i, -size, i, size);
+        sink.segment(-size, i, size, i);
+    }
+}
+
+// ----------------------
+// Sinks
+// ----------------------
+struct PointListSink {
+    std::vector<Point>& points;
+    explicit PointListSink(std::vector<Point>& out) : points(out) {}
+
+    void point(int x, int y) { points.push_back(Point{x, y}); }
+    void segment(int x0, int y0, int x1, int y1) { line(x0, y0, x1, y1, *this); }
+};
+
+// Lines go straight through the span kernel; lone points become 1-pixel spans
+struct SpanListSink {
+    std::vector<LineSpan>& spans;
+    explicit SpanListSink(std::vector<LineSpan>& out) : spans(out) {}
+
+    void point(int x, int y) {
+        LineSpan s;
+        setSpan(s, x, y, 1, false, 1);
+        spans.push_back(s);
+    }
+    void segment(int x0, int y0, int x1, int y1) { lineSpans(x0, y0, x1, y1, spans); }
+};
+
+inline void line(int x0, int y0, int x1, int y1, SpanListSink& sink) {
+    lineSpans(x0, y0, x1, y1, sink.spans);
+}
+
+struct CoveragePoint {
+    int x, y;
+    int weight;     // 1..255, 255 = full pixel
+};
+
+struct CoverageListSink {
+    std::vector<CoveragePoint>& points;
+    explicit CoverageListSink(std::vector<CoveragePoint>& out) : points(out) {}
+
+    void point(int x, int y) { points.push_back(CoveragePoint{x, y, 255}); }
+    void coverage(int x, int y, int weight) { points.push_back(CoveragePoint{x, y, weight}); }
+    void segment(int x0, int y0, int x1, int y1) { wuLine(x0, y0, x1, y1, *this); }
+};
+
+// dst + (src - dst) * weight / 255 per 8-bit channel of a packed pixel;
+// other pixel types take the source above half coverage
+inline uint32_t blendPixel(uint32_t dst, uint32_t src, int weight) {
+    uint32_t rb = dst & 0x00FF00FFu, ga = (dst >> 8) & 0x00FF00FFu;
+    uint32_t srb = src & 0x00FF00FFu, sga = (src >> 8) & 0x00FF00FFu;
+    uint32_t w = (uint32_t)weight + (weight >> 7);   // 0..256
+    rb = (rb + (((srb - rb) * w) >> 8)) & 0x00FF00FFu;
+    ga = (ga + (((sga - ga) * w) >> 8)) & 0x00FF00FFu;
+    return rb | (ga << 8);
+}
+
+template <typename Pixel>
+inline Pixel blendPixel(Pixel dst, Pixel src, int weight) {
+    return weight >= 128 ? src : dst;
+}
+
+// Writes `color` into a row-major pixel array; pixels outside are clipped
+// (segments before rasterisation). Coordinates are used as-is (origin at
+// pixel 0,0).
+template <typename Pixel>
+struct FramebufferSink {
+    Pixel* pixels;
+    int width, height, stride;   // stride in pixels
+    Pixel color;
+
+    FramebufferSink(Pixel* pixels, int width, int height, Pixel color)
+        : pixels(pixels), width(width), height(height), stride(width), color(color) {}
+
+    void point(int x, int y) {
+        if ((unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height)
+            pixels[(size_t)y * stride + x] = color;
+    }
+    void coverage(int x, int y, int weight) {
+        if ((unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height) {
+            Pixel& p = pixels[(size_t)y * stride + x];
+            p = blendPixel(p, color, weight);
+        }
+    }
+    void segment(int x0, int y0, int x1, int y1) {
+        clippedLine(x0, y0, x1, y1, ClipRect{0, 0, width - 1, height - 1}, *this);
+    }
+};
+
+} // namespace raster
+
+#endif
@@ -0,0 +1,25 @@
+// ======================
+// Raster Sinks - Immediate-Mode GL
+// ======================
+// Feeds raster.h output straight to glVertex. Call between glBegin/glEnd:
+// GL_POINTS for line/circle pixels, GL_LINES for grid segments.
+
+#ifndef COSMIC_RASTER_GL_H
+#define COSMIC_RASTER_GL_H
+
+#include <GL/glut.h>
+#include "raster.h"
+
+namespace raster {
+
+struct ImmediateSink {
+    void point(int x, int y) { glVertex2i(x, y); }
+    void segment(int x0, int y0, int x1, int y1) {
+        glVertex2f((float)x0, (float)y0);
+        glVertex2f((float)x1, (float)y1);
+    }
+};
+
+} // namespace raster
+
+#endif
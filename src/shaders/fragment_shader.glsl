@@ -0,0 +1,16 @@
+// ======================
+// Star point sprites - fragment stage
+// ======================
+// Gaussian-like falloff across the sprite; drawn with additive blending so
+// overlapping stars accumulate instead of occluding each other.
+#version 120
+
+varying vec3 starColor;
+
+void main() {
+    vec2 d = gl_PointCoord * 2.0 - 1.0;
+    float r2 = dot(d, d);
+    if (r2 > 1.0) discard;
+    float falloff = exp(-3.0 * r2);
+    gl_FragColor = vec4(starColor * falloff, 1.0);
+}
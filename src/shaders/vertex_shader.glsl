@@ -0,0 +1,35 @@
+// ======================
+// Star point sprites - vertex stage
+// ======================
+// Positions arrive as normalised int16 (scaled back by positionScale), the
+// magnitude and twinkle phase as two bytes in starAttrib. Point size and
+// brightness both follow the star's flux relative to referenceMagnitude.
+// Stars within fadeWidth of magnitudeLimit are dimmed so the level-of-detail
+// limit can move without stars popping in.
+#version 120
+
+attribute vec2 starAttrib;      // x: (mag + 2) * 10, y: twinkle phase 0..255
+
+uniform float positionScale;    // int16 -> world units
+uniform float pointScale;       // diameter in pixels of a referenceMagnitude star
+uniform float referenceMagnitude;
+uniform float brightness;       // global gain
+uniform float magnitudeLimit;   // faintest star drawn
+uniform float fadeWidth;        // magnitudes over which stars fade in
+uniform float twinkleAmount;    // 0 = steady
+uniform float time;             // seconds
+
+varying vec3 starColor;
+
+void main() {
+    float mag = starAttrib.x * 0.1 - 2.0;
+    float flux = pow(10.0, -0.4 * (mag - referenceMagnitude));
+    float fade = clamp((magnitudeLimit - mag) / max(fadeWidth, 0.001), 0.0, 1.0);
+
+    float phase = starAttrib.y * 0.02464;   // 0..2pi
+    float twinkle = 1.0 + twinkleAmount * sin(time * 3.1 + phase) * sin(time * 1.7 + phase * 2.0);
+
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(gl_Vertex.xyz * positionScale, 1.0);
+    gl_PointSize = clamp(pointScale * sqrt(flux), 1.0, 32.0);
+    starColor = gl_Color.rgb * min(flux, 1.0) * fade * brightness * twinkle;
+}
@@ -0,0 +1,208 @@
+// ======================
+// Compile-Time Baked Overlay Geometry
+// ======================
+// The planet orbits, planet discs and the default constellation chart are
+// fixed, so their pixels are rasterised by the compiler: raster::orbit,
+// raster::circle and raster::line are constexpr, and a constexpr sink collects their output into
+// static point tables that end up in read-only data. Building those layers is
+// then a copy, with no rasterisation at start-up.
+//
+// The tables come from the same raster.h code the runtime uses, so they are
+// identical by construction; --bench-raster re-checks them against the
+// runtime path. Geometry that differs from these tables (e.g. a different
+// constellation file) falls back to runtime rasterisation.
+
+#ifndef COSMIC_BAKED_OVERLAYS_H
+#define COSMIC_BAKED_OVERLAYS_H
+
+#include <cstddef>
+#include "../algorithms/raster.h"
+
+namespace baked {
+
+struct Circle {
+    int xc, yc, r;
+};
+
+// Integer orbit for raster::orbit (see OrbitShape in orbit_batch.h)
+struct Orbit {
+    int xf, yf, a, b, c;
+    raster::Rotation rot;
+};
+
+// Points of several shapes, back to back; shape i is [first[i], first[i + 1])
+template <int Points, int Shapes>
+struct PointTable {
+    raster::Point points[Points];
+    int first[Shapes + 1];
+
+    constexpr int shapeCount() const { return Shapes; }
+    constexpr const raster::Point* begin(int shape) const { return points + first[shape]; }
+    constexpr const raster::Point* end(int shape) const { return points + first[shape + 1]; }
+};
+
+// ----------------------
+// Constexpr sinks
+// ----------------------
+struct CountSink {
+    int count = 0;
+    constexpr void point(int, int) { count++; }
+};
+
+template <int Points, int Shapes>
+struct TableSink {
+    PointTable<Points, Shapes>& table;
+    int count;
+    constexpr void point(int x, int y) { table.points[count++] = raster::Point{x, y}; }
+};
+
+// ----------------------
+// Bakers
+// ----------------------
+template <size_t N>
+constexpr int circlePoints(const Circle (&circles)[N]) {
+    CountSink sink;
+    for (size_t i = 0; i < N; i++) raster::circle(circles[i].xc, circles[i].yc, circles[i].r, sink);
+    return sink.count;
+}
+
+template <size_t N>
+constexpr int orbitPoints(const Orbit (&orbits)[N]) {
+    CountSink sink;
+    for (size_t i = 0; i < N; i++) {
+        const Orbit& o = orbits[i];
+        raster::orbit(o.xf, o.yf, o.a, o.b, o.c, o.rot, sink);
+    }
+    return sink.count;
+}
+
+template <size_t N>
+constexpr int linePoints(const LineSegment (&segments)[N]) {
+    CountSink sink;
+    for (size_t i = 0; i < N; i++)
+        raster::line(segments[i].x0, segments[i].y0, segments[i].x1, segments[i].y1, sink);
+    return sink.count;
+}
+
+template <int Points, size_t N>
+constexpr PointTable<Points, (int)N> bakeCircles(const Circle (&circles)[N]) {
+    PointTable<Points, (int)N> table{};
+    TableSink<Points, (int)N> sink{table, 0};
+    for (size_t i = 0; i < N; i++) {
+        table.first[i] = sink.count;
+        raster::circle(circles[i].xc, circles[i].yc, circles[i].r, sink);
+    }
+    table.first[N] = sink.count;
+    return table;
+}
+
+template <int Points, size_t N>
+constexpr PointTable<Points, (int)N> bakeOrbits(const Orbit (&orbits)[N]) {
+    PointTable<Points, (int)N> table{};
+    TableSink<Points, (int)N> sink{table, 0};
+    for (size_t i = 0; i < N; i++) {
+        table.first[i] = sink.count;
+        raster::orbit(orbits[i].xf, orbits[i].yf, orbits[i].a, orbits[i].b, orbits[i].c,
+                      orbits[i].rot, sink);
+    }
+    table.first[N] = sink.count;
+    return table;
+}
+
+template <int Points, size_t N>
+constexpr PointTable<Points, (int)N> bakeLines(const LineSegment (&segments)[N]) {
+    PointTable<Points, (int)N> table{};
+    TableSink<Points, (int)N> sink{table, 0};
+    for (size_t i = 0; i < N; i++) {
+        table.first[i] = sink.count;
+        raster::line(segments[i].x0, segments[i].y0, segments[i].x1, segments[i].y1, sink);
+    }
+    table.first[N] = sink.count;
+    return table;
+}
+
+// Rounds v / 2^28 half away from zero (a 2.14 product of 2.14 values)
+constexpr int fixedRound28(long long v) {
+    return v >= 0 ? (int)((v + (1LL << 27)) >> 28) : -(int)((-v + (1LL << 27)) >> 28);
+}
+
+// Centre of a planet disc of radius r on `orbit`, in the scene direction
+// `bearing` (2.14 cos / sin) from the focus. The true anomaly is bearing
+// minus periapsis, and the focal radius uses the orbit's own rounded a, b
+// and c, so the disc sits on the ellipse raster::orbit draws.
+constexpr Circle planetOnOrbit(const Orbit& o, raster::Rotation bearing, int r) {
+    // cos / sin of the true anomaly, 2.14
+    long long cv = ((long long)bearing.c * o.rot.c + (long long)bearing.s * o.rot.s) >> 14;
+    long long sv = ((long long)bearing.s * o.rot.c - (long long)bearing.c * o.rot.s) >> 14;
+    // Focus-centred ellipse: x = (a^2 - c^2) cos v / (a + c cos v), y = b^2 sin v / (a + c cos v)
+    long long den = (long long)o.a * (1 << 14) + o.c * cv;
+    long long x = ((long long)o.a * o.a - (long long)o.c * o.c) * cv * (1 << 14) / den;
+    long long y = (long long)o.b * o.b * sv * (1 << 14) / den;
+    return Circle{o.xf + fixedRound28(x * o.rot.c - y * o.rot.s),
+                  o.yf + fixedRound28(x * o.rot.s + y * o.rot.c), r};
+}
+
+// ----------------------
+// Fixed scene geometry
+// ----------------------
+// Planetary orbits with the Sun at a focus: a = scene radius, b and c from
+// the real eccentricity (rounded to pixels), periapsis along the longitude
+// of perihelion as 2.14 cos / sin
+constexpr Orbit kOrbits[] = {
+    {0, 0, 15, 15, 3, {3557, 15993}},     // Mercury  e 0.206, 77.5 deg
+    {0, 0, 20, 20, 0, {-10863, 12265}},   // Venus    e 0.007, 131.5 deg
+    {0, 0, 25, 25, 0, {-3672, 15967}},    // Earth    e 0.017, 103.0 deg
+    {0, 0, 32, 32, 3, {14972, -6654}},    // Mars     e 0.093, 336.0 deg
+    {0, 0, 42, 42, 2, {15844, 4171}},     // Jupiter  e 0.049, 14.8 deg (outer planets)
+};
+
+// Planet discs, in the order the 3/4 keys add them. The five with an orbit
+// sit on it, at their old bearings from the Sun (2.14 cos / sin).
+constexpr Circle kPlanets[] = {
+    planetOnOrbit(kOrbits[0], {16384, 0}, 3),        // Mercury  0 deg
+    planetOnOrbit(kOrbits[1], {0, -16384}, 4),       // Venus    270 deg
+    planetOnOrbit(kOrbits[2], {-16384, 0}, 5),       // Earth    180 deg
+    planetOnOrbit(kOrbits[3], {15831, 4221}, 4),     // Mars     14.9 deg
+    planetOnOrbit(kOrbits[4], {-8129, 14225}, 8),    // Jupiter  119.7 deg
+    {35, -30, 7},   // Saturn
+    {-40, -20, 5},  // Uranus
+    {40, 30, 5},    // Neptune
+};
+
+// Floor segments of assets/data/constellations.txt as shipped, in file order
+// (Ori, UMa, Cas, OriBelt)
+constexpr LineSegment kChartSegments[] = {
+    {-20, 15, -8, 0}, {20, 15, 8, 0}, {-8, 0, -15, -20}, {8, 0, 15, -20}, {-15, -20, 15, -20},
+    {50, 50, 60, 45}, {60, 45, 65, 35}, {65, 35, 60, 30}, {60, 30, 50, 50},
+    {60, 30, 55, 25}, {55, 25, 50, 18}, {50, 18, 45, 10},
+    {-60, 50, -55, 40}, {-55, 40, -50, 45}, {-50, 45, -45, 40}, {-45, 40, -40, 50},
+    {-8, 0, 0, 0}, {0, 0, 8, 0},
+};
+
+constexpr int kOrbitPoints = orbitPoints(kOrbits);
+constexpr int kPlanetPoints = circlePoints(kPlanets);
+constexpr int kChartPoints = linePoints(kChartSegments);
+
+constexpr PointTable<kOrbitPoints, 5> kOrbitTable = bakeOrbits<kOrbitPoints>(kOrbits);
+constexpr PointTable<kPlanetPoints, 8> kPlanetTable = bakeCircles<kPlanetPoints>(kPlanets);
+constexpr PointTable<kChartPoints, 18> kChartTable = bakeLines<kChartPoints>(kChartSegments);
+
+// Spot checks evaluated by the compiler
+static_assert(kOrbitTable.points[kOrbitTable.first[1]] == raster::Point{-15, -13},
+              "Venus starts at its rotated minor-axis vertex");
+static_assert(kPlanets[0].xc == 14 && kPlanets[0].yc == 0, "Mercury sits on its orbit, 14 px out at 0 deg");
+static_assert(kChartTable.first[1] - kChartTable.first[0] == 16, "Betelgeuse-Alnitak is 16 pixels");
+static_assert(kChartTable.end(17)[-1] == raster::Point{8, 0}, "belt ends at Mintaka");
+
+// True when `segments` is exactly the baked chart
+inline bool isBakedChart(const LineSegment* segments, size_t count) {
+    const size_t n = sizeof(kChartSegments) / sizeof(kChartSegments[0]);
+    if (count != n) return false;
+    for (size_t i = 0; i < n; i++)
+        if (!(segments[i] == kChartSegments[i])) return false;
+    return true;
+}
+
+} // namespace baked
+
+#endif
@@ -0,0 +1,982 @@
+// ======================
+// Command-Line Benchmarks
+// ======================
+// Offline micro-benchmarks run with --bench-<name>; they need no GL context
+// and print plain tables to stdout. The ones that also check their output
+// against a reference return the number of failures, which main() turns
+// into a non-zero exit code for scripts and CI.
+
+#ifndef COSMIC_BENCHMARKS_H
+#define COSMIC_BENCHMARKS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "baked_overlays.h"
+#include "circle_cache.h"
+#include "line_spans.h"
+#include "orbit_batch.h"
+#include "sky_index.h"
+#include "star_catalog.h"
+#include "star_field.h"
+#include "transform.h"
+
+namespace bench {
+
+typedef std::chrono::steady_clock Clock;
+
+inline double elapsedUs(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+inline double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)std::min<double>(v.size() - 1, p * (v.size() - 1) + 0.5);
+    return v[i];
+}
+
+// gluPerspective * gluLookAt(origin -> dir), enough for culling tests
+inline void viewProjection(const float dir[3], float fovYDeg, float aspect, float out[16]) {
+    Vec3 up = std::fabs(dir[1]) > 0.99f ? Vec3{1, 0, 0} : Vec3{0, 1, 0};
+    Mat4 m = perspective(fovYDeg, aspect, 1.0f, 1000.0f) * lookAt(Vec3{0, 0, 0}, Vec3{dir[0], dir[1], dir[2]}, up);
+    std::copy(m.m, m.m + 16, out);
+}
+
+// Uniform sky with a realistic magnitude distribution, N(<m) ~ 10^(0.5 m),
+// normalised so roughly 8000 stars are brighter than magnitude 6.5.
+inline void syntheticCatalog(size_t n, uint64_t seed, std::vector<CatalogStar>& out) {
+    StarRng rng(seed);
+    float faintest = 6.5f + 2.0f * std::log10(std::max(1.0f, n / 8000.0f));
+    out.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        float z = rng.range(-1.0f, 1.0f);
+        float phi = rng.range(0.0f, 6.2831853f);
+        float r = std::sqrt(1.0f - z * z);
+        CatalogStar& s = out[i];
+        s.dir[0] = r * std::cos(phi);
+        s.dir[1] = r * std::sin(phi);
+        s.dir[2] = z;
+        s.mag = faintest + 2.0f * std::log10(std::max(rng.nextFloat(), 1e-9f));
+        s.ci = 0.6f;
+        s.hip = 0;
+    }
+}
+
+// ----------------------
+// --bench-sky-index
+// ----------------------
+// Frustum + magnitude query latency against catalog size; the last case per
+// size applies a 100k star budget (the LOD's bound for wide views). The
+// first views of each row are also checked against a brute-force frustum
+// test over every star; returns the visible stars a query left out.
+
+// Stars brighter than the applied limit that lie inside the frustum but in
+// none of the returned ranges. returned is scratch, all zero on entry and exit.
+inline size_t missedStars(const std::vector<CatalogStar>& stars, const Frustum& frustum, float skyRadius,
+                          const SkyQuery& result, std::vector<uint8_t>& returned) {
+    for (size_t r = 0; r < result.first.size(); r++)
+        std::fill_n(returned.begin() + result.first[r], result.count[r], 1);
+    size_t missed = 0;
+    for (size_t i = 0; i < stars.size(); i++) {
+        if (returned[i] || !(stars[i].mag < result.magLimit)) continue;
+        float p[3];
+        skycell::toScene(stars[i].dir, p);
+        // Negative radius: only stars clearly inside, not ones on a plane
+        if (frustum.testSphere(p[0] * skyRadius, p[1] * skyRadius, p[2] * skyRadius, -1e-3f) !=
+            FRUSTUM_OUTSIDE)
+            missed++;
+    }
+    for (size_t r = 0; r < result.first.size(); r++)
+        std::fill_n(returned.begin() + result.first[r], result.count[r], 0);
+    return missed;
+}
+
+inline int runSkyIndexBenchmark() {
+    const size_t sizes[] = {120000, 500000, 1000000, 2500000, 10000000};
+    const float limits[] = {6.5f, 9.0f, 99.0f, 99.0f};
+    const size_t budgets[] = {0, 0, 0, 100000};
+    const int queries = 200;
+    const int checked = 8;     // views per row compared with brute force
+
+    std::printf("Sky index query benchmark (60 deg FOV, %d random views per row, first %d checked)\n",
+                queries, checked);
+    std::printf("%10s %9s %6s %8s %10s %10s %12s %8s %8s\n", "stars", "build ms", "mag<",
+                "budget", "mean us", "p99 us", "stars out", "ranges", "missed");
+
+    size_t failures = 0;
+    for (size_t n : sizes) {
+        std::vector<CatalogStar> stars;
+        syntheticCatalog(n, 42, stars);
+
+        Clock::time_point t0 = Clock::now();
+        std::vector<uint32_t> cellStart;
+        buildSkyIndex(stars, kSkyIndexDepth, cellStart);
+        SkyIndex<CatalogStar> index;
+        index.build(stars.data(), cellStart.data(), kSkyIndexDepth);
+        double buildMs = elapsedUs(t0) / 1000.0;
+        std::vector<uint8_t> returned(n, 0);
+
+        for (int c = 0; c < 4; c++) {
+            float limit = limits[c];
+            StarRng rng(7);
+            SkyQuery result;
+            std::vector<double> times;
+            double outStars = 0, outRanges = 0;
+            size_t missed = 0;
+            for (int q = 0; q < queries; q++) {
+                float z = rng.range(-1.0f, 1.0f), phi = rng.range(0.0f, 6.2831853f);
+                float r = std::sqrt(1.0f - z * z);
+                float dir[3] = {r * std::cos(phi), z, r * std::sin(phi)};
+                float m[16];
+                viewProjection(dir, 60.0f, 4.0f / 3.0f, m);
+                Frustum frustum;
+                frustum.fromMatrix(m);
+
+                Clock::time_point start = Clock::now();
+                index.query(frustum, 400.0f, limit, result, budgets[c]);
+                times.push_back(elapsedUs(start));
+                outStars += result.stars;
+                outRanges += result.first.size();
+                if (q < checked) missed += missedStars(stars, frustum, 400.0f, result, returned);
+            }
+            double mean = 0;
+            for (double t : times) mean += t;
+            mean /= times.size();
+            std::printf("%10zu %9.1f %6.1f %8zu %10.1f %10.1f %12.0f %8.0f %8zu\n", n, buildMs,
+                        limit, budgets[c], mean, percentile(times, 0.99),
+                        outStars / queries, outRanges / queries, missed);
+            failures += missed;
+        }
+    }
+    std::printf("Sky index vs brute-force frustum test: %s (%zu stars missed)\n",
+                failures ? "FAILED" : "ok", failures);
+    return (int)std::min<size_t>(failures, 1 << 30);
+}
+
+// ----------------------
+// --bench-lines
+// ----------------------
+// Per-pixel Bresenham vs the span kernel vs the span cache, for batches of
+// random segments; then clipped against unclipped lines for long segments
+// that are mostly off screen. Returns the windows where clipping changed the
+// pixels.
+inline int runLineBenchmark() {
+    const size_t batchSizes[] = {1000, 10000, 100000};
+    const int lengths[] = {16, 64, 256};
+    const int reps = 5;
+
+    std::printf("Line rasteriser benchmark (ms per batch, best of %d)\n", reps);
+    std::printf("%8s %6s %10s %10s %10s %10s %10s\n", "segments", "length",
+                "per-pixel", "spans", "cache hit", "cache 1%", "spans/seg");
+
+    for (size_t n : batchSizes) {
+        for (int length : lengths) {
+            StarRng rng(11);
+            std::vector<LineSegment> segs(n);
+            for (LineSegment& s : segs) {
+                s.x0 = (int)rng.range(-1000.0f, 1000.0f);
+                s.y0 = (int)rng.range(-1000.0f, 1000.0f);
+                float a = rng.range(0.0f, 6.2831853f);
+                s.x1 = s.x0 + (int)(length * std::cos(a));
+                s.y1 = s.y0 + (int)(length * std::sin(a));
+            }
+
+            double perPixel = 1e30, spanMs = 1e30, hitMs = 1e30, dirtyMs = 1e30;
+            std::vector<raster::Point> points;
+            raster::PointListSink pointSink(points);
+            std::vector<LineSpan> spans;
+            LineSpanCache cache;
+            cache.update(segs.data(), n);
+            for (int r = 0; r < reps; r++) {
+                Clock::time_point t = Clock::now();
+                points.clear();
+                for (const LineSegment& s : segs) raster::line(s.x0, s.y0, s.x1, s.y1, pointSink);
+                perPixel = std::min(perPixel, elapsedUs(t) / 1000.0);
+
+                t = Clock::now();
+                spans.clear();
+                for (const LineSegment& s : segs) raster::lineSpans(s.x0, s.y0, s.x1, s.y1, spans);
+                spanMs = std::min(spanMs, elapsedUs(t) / 1000.0);
+
+                t = Clock::now();
+                cache.update(segs.data(), n);
+                hitMs = std::min(hitMs, elapsedUs(t) / 1000.0);
+
+                for (size_t i = r; i < n; i += 100) segs[i].x1 += (r & 1) ? -1 : 1;
+                t = Clock::now();
+                cache.update(segs.data(), n);
+                dirtyMs = std::min(dirtyMs, elapsedUs(t) / 1000.0);
+            }
+            std::printf("%8zu %6d %10.3f %10.3f %10.3f %10.3f %10.1f\n", n, length, perPixel,
+                        spanMs, hitMs, dirtyMs, (double)spans.size() / n);
+        }
+    }
+
+    // Long segments through a small visible window: walking every step and
+    // testing each pixel vs clipping before rasterisation
+    struct WindowSink {
+        std::vector<raster::Point>& out;
+        raster::ClipRect clip;
+        void point(int x, int y) {
+            if (clip.contains(x, y)) out.push_back(raster::Point{x, y});
+        }
+    };
+    const int windows[] = {64, 256, 1024};
+    const size_t n = 10000;
+    std::printf("\nClipped lines: %zu segments across -2048..2048, window centred (ms, best of %d)\n",
+                n, reps);
+    std::printf("%8s %10s %10s %10s %10s %6s\n", "window", "per-pixel", "clipped", "clip spans",
+                "pixels", "exact");
+    int failures = 0;
+    for (int w : windows) {
+        StarRng rng(13);
+        std::vector<LineSegment> segs(n);
+        for (LineSegment& s : segs) {
+            s.x0 = (int)rng.range(-2048.0f, 2048.0f);
+            s.y0 = (int)rng.range(-2048.0f, 2048.0f);
+            s.x1 = (int)rng.range(-2048.0f, 2048.0f);
+            s.y1 = (int)rng.range(-2048.0f, 2048.0f);
+        }
+        raster::ClipRect clip = {-w / 2, -w / 2, w / 2 - 1, w / 2 - 1};
+        std::vector<raster::Point> walked, clipped;
+        std::vector<LineSpan> spans;
+        WindowSink windowSink{walked, clip};
+        raster::PointListSink clipSink(clipped);
+        double walkMs = 1e30, clipMs = 1e30, spanMs = 1e30;
+        for (int r = 0; r < reps; r++) {
+            Clock::time_point t = Clock::now();
+            walked.clear();
+            for (const LineSegment& s : segs) raster::line(s.x0, s.y0, s.x1, s.y1, windowSink);
+            walkMs = std::min(walkMs, elapsedUs(t) / 1000.0);
+
+            t = Clock::now();
+            clipped.clear();
+            for (const LineSegment& s : segs) raster::clippedLine(s.x0, s.y0, s.x1, s.y1, clip, clipSink);
+            clipMs = std::min(clipMs, elapsedUs(t) / 1000.0);
+
+            t = Clock::now();
+            spans.clear();
+            for (const LineSegment& s : segs)
+                raster::clippedLineSpans(s.x0, s.y0, s.x1, s.y1, clip, spans);
+            spanMs = std::min(spanMs, elapsedUs(t) / 1000.0);
+        }
+        std::printf("%8d %10.3f %10.3f %10.3f %10zu %6s\n", w, walkMs, clipMs, spanMs, clipped.size(),
+                    clipped == walked ? "yes" : "NO");
+        if (!(clipped == walked)) failures++;
+    }
+    return failures;
+}
+
+// ----------------------
+// --bench-raster
+// ----------------------
+// First checks raster.h against the original per-pixel loops (the code that
+// used to live in main.cpp and src/algorithms/*.cpp) and the compile-time
+// overlay tables against raster.h, pixel for pixel, then
+// times each rasteriser per sink across line lengths and circle radii.
+
+// Reference copies of the original loops
+inline void referenceLine(int x0, int y0, int x1, int y1, std::vector<raster::Point>& out) {
+    int dx = std::abs(x1 - x0), dy = std::abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+    while (true) {
+        out.push_back(raster::Point{x0, y0});
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 > -dy) { err -= dy; x0 += sx; }
+        if (e2 < dx) { err += dx; y0 += sy; }
+    }
+}
+
+inline void referenceCircle(int xc, int yc, int r, std::vector<raster::Point>& out) {
+    int x = 0, y = r, d = 1 - r;
+    while (x <= y) {
+        raster::Point p[8] = {{xc + x, yc + y}, {xc - x, yc + y}, {xc + x, yc - y}, {xc - x, yc - y},
+                              {xc + y, yc + x}, {xc - y, yc + x}, {xc + y, yc - x}, {xc - y, yc - x}};
+        out.insert(out.end(), p, p + 8);
+        if (d < 0) {
+            d += 2 * x + 3;
+        } else {
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
+}
+
+inline bool pointLess(const raster::Point& a, const raster::Point& b) {
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+}
+
+// Returns the number of mismatching primitives
+inline int verifyRaster() {
+    int failures = 0;
+    std::vector<raster::Point> expected, got;
+    std::vector<LineSpan> spans;
+    raster::PointListSink pointSink(got);
+
+    for (int x0 = -2; x0 <= 2; x0++)
+        for (int y0 = -2; y0 <= 2; y0++)
+            for (int x1 = -40; x1 <= 40; x1++)
+                for (int y1 = -40; y1 <= 40; y1++) {
+                    expected.clear();
+                    referenceLine(x0, y0, x1, y1, expected);
+                    got.clear();
+                    raster::line(x0, y0, x1, y1, pointSink);
+                    bool ok = got == expected;
+
+                    spans.clear();
+                    raster::lineSpans(x0, y0, x1, y1, spans);
+                    got.clear();
+                    raster::spanPixels(spans.data(), spans.size(), pointSink);
+                    ok = ok && got == expected;
+                    if (!ok) failures++;
+                }
+
+    for (int r = 0; r <= 300; r++) {
+        expected.clear();
+        referenceCircle(3, -7, r, expected);
+        got.clear();
+        raster::circle(3, -7, r, pointSink);
+        if (got != expected) failures++;
+    }
+
+    // Clipped lines and spans are line()'s pixels inside the rect, in order
+    StarRng clipRng(9);
+    for (int i = 0; i < 100000; i++) {
+        int range = i < 50000 ? 40 : 4000;
+        int x0 = (int)clipRng.range(-range, range), y0 = (int)clipRng.range(-range, range);
+        int x1 = (int)clipRng.range(-range, range), y1 = (int)clipRng.range(-range, range);
+        int cx = (int)clipRng.range(-range / 2, range / 2), cy = (int)clipRng.range(-range / 2, range / 2);
+        raster::ClipRect clip = {cx, cy, cx + (int)clipRng.range(0, range), cy + (int)clipRng.range(0, range)};
+        got.clear();
+        raster::line(x0, y0, x1, y1, pointSink);
+        expected.clear();
+        for (const raster::Point& p : got)
+            if (clip.contains(p.x, p.y)) expected.push_back(p);
+
+        got.clear();
+        raster::clippedLine(x0, y0, x1, y1, clip, pointSink);
+        bool ok = got == expected;
+        spans.clear();
+        raster::clippedLineSpans(x0, y0, x1, y1, clip, spans);
+        got.clear();
+        raster::spanPixels(spans.data(), spans.size(), pointSink);
+        if (!ok || got != expected) failures++;
+    }
+
+    // Ellipse quadrants run (0, ry) to (rx, 0) in 8-neighbour steps, and an
+    // unrotated orbit around its centre draws the same pixels as ellipse()
+    for (int rx = 0; rx <= 64; rx++)
+        for (int ry = 0; ry <= 64; ry++) {
+            got.clear();
+            raster::ellipseQuadrant(rx, ry, pointSink);
+            bool ok = got.front() == raster::Point{0, ry} && got.back() == raster::Point{rx, 0};
+            for (size_t i = 1; i < got.size(); i++) {
+                int dx = std::abs(got[i].x - got[i - 1].x), dy = std::abs(got[i].y - got[i - 1].y);
+                if (std::max(dx, dy) != 1) ok = false;
+            }
+
+            got.clear();
+            raster::ellipse(5, -3, rx, ry, pointSink);
+            expected = got;
+            got.clear();
+            raster::orbit(5, -3, rx, ry, 0, raster::kNoRotation, pointSink);
+            std::sort(expected.begin(), expected.end(), pointLess);
+            expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+            std::sort(got.begin(), got.end(), pointLess);
+            got.erase(std::unique(got.begin(), got.end()), got.end());
+            if (!ok || got != expected) failures++;
+        }
+
+    // Compile-time tables vs the runtime rasterisers, bit for bit
+    for (size_t i = 0; i < sizeof(baked::kOrbits) / sizeof(baked::kOrbits[0]); i++) {
+        got.clear();
+        const baked::Orbit& o = baked::kOrbits[i];
+        raster::orbit(o.xf, o.yf, o.a, o.b, o.c, o.rot, pointSink);
+        if (!std::equal(got.begin(), got.end(), baked::kOrbitTable.begin((int)i)) ||
+            got.size() != (size_t)(baked::kOrbitTable.end((int)i) - baked::kOrbitTable.begin((int)i)))
+            failures++;
+    }
+    for (size_t i = 0; i < sizeof(baked::kPlanets) / sizeof(baked::kPlanets[0]); i++) {
+        got.clear();
+        raster::circle(baked::kPlanets[i].xc, baked::kPlanets[i].yc, baked::kPlanets[i].r, pointSink);
+        if (!std::equal(got.begin(), got.end(), baked::kPlanetTable.begin((int)i)) ||
+            got.size() != (size_t)(baked::kPlanetTable.end((int)i) - baked::kPlanetTable.begin((int)i)))
+            failures++;
+    }
+    for (size_t i = 0; i < sizeof(baked::kChartSegments) / sizeof(baked::kChartSegments[0]); i++) {
+        const LineSegment& s = baked::kChartSegments[i];
+        got.clear();
+        raster::line(s.x0, s.y0, s.x1, s.y1, pointSink);
+        if (!std::equal(got.begin(), got.end(), baked::kChartTable.begin((int)i)) ||
+            got.size() != (size_t)(baked::kChartTable.end((int)i) - baked::kChartTable.begin((int)i)))
+            failures++;
+    }
+
+    // Grid: every segment becomes the same two endpoints the GL_LINES loop used
+    std::vector<raster::Point> ends;
+    struct EndpointSink {
+        std::vector<raster::Point>& out;
+        void point(int, int) {}
+        void segment(int x0, int y0, int x1, int y1) {
+            out.push_back(raster::Point{x0, y0});
+            out.push_back(raster::Point{x1, y1});
+        }
+    } endpointSink{ends};
+    raster::grid(100, 10, endpointSink);
+    size_t k = 0;
+    for (int i = -100; i <= 100; i += 10) {
+        raster::Point p[4] = {{i, -100}, {i, 100}, {-100, i}, {100, i}};
+        for (int j = 0; j < 4; j++)
+            if (k >= ends.size() || !(ends[k++] == p[j])) { failures++; break; }
+    }
+    return failures;
+}
+
+// Returns the mismatches
+inline int runRasterBenchmark() {
+    int failures = verifyRaster();
+    std::printf("Pixel-exactness vs original loops: %s (%d mismatches)\n",
+                failures ? "FAILED" : "ok", failures);
+
+    const int size = 2048;
+    std::vector<uint32_t> pixels((size_t)size * size);
+    std::vector<raster::Point> points;
+    std::vector<LineSpan> spans;
+    raster::PointListSink pointSink(points);
+    raster::SpanListSink spanSink(spans);
+    raster::FramebufferSink<uint32_t> fbSink(pixels.data(), size, size, 0xFFFFFFFFu);
+
+    const int lengths[] = {8, 64, 512};
+    std::printf("\nLines: ns per line (1000 random directions)\n");
+    std::printf("%8s %10s %10s %12s\n", "length", "points", "spans", "framebuffer");
+    for (int length : lengths) {
+        StarRng rng(5);
+        std::vector<LineSegment> segs(1000);
+        for (LineSegment& s : segs) {
+            float a = rng.range(0.0f, 6.2831853f);
+            s.x0 = size / 2; s.y0 = size / 2;
+            s.x1 = s.x0 + (int)(length * std::cos(a));
+            s.y1 = s.y0 + (int)(length * std::sin(a));
+        }
+        double t[3] = {1e30, 1e30, 1e30};
+        for (int rep = 0; rep < 5; rep++) {
+            Clock::time_point start = Clock::now();
+            points.clear();
+            for (const LineSegment& s : segs) raster::line(s.x0, s.y0, s.x1, s.y1, pointSink);
+            t[0] = std::min(t[0], elapsedUs(start));
+            start = Clock::now();
+            spans.clear();
+            for (const LineSegment& s : segs) raster::line(s.x0, s.y0, s.x1, s.y1, spanSink);
+            t[1] = std::min(t[1], elapsedUs(start));
+            start = Clock::now();
+            for (const LineSegment& s : segs) raster::line(s.x0, s.y0, s.x1, s.y1, fbSink);
+            t[2] = std::min(t[2], elapsedUs(start));
+        }
+        std::printf("%8d %10.1f %10.1f %12.1f\n", length, t[0], t[1], t[2]);
+    }
+
+    const int radii[] = {4, 32, 256};
+    std::printf("\nCircles: ns per circle (1000 circles)\n");
+    std::printf("%8s %10s %12s\n", "radius", "points", "framebuffer");
+    for (int r : radii) {
+        double t[2] = {1e30, 1e30};
+        for (int rep = 0; rep < 5; rep++) {
+            Clock::time_point start = Clock::now();
+            points.clear();
+            for (int i = 0; i < 1000; i++) raster::circle(size / 2, size / 2, r, pointSink);
+            t[0] = std::min(t[0], elapsedUs(start));
+            start = Clock::now();
+            for (int i = 0; i < 1000; i++) raster::circle(size / 2, size / 2, r, fbSink);
+            t[1] = std::min(t[1], elapsedUs(start));
+        }
+        std::printf("%8d %10.1f %12.1f\n", r, t[0], t[1]);
+    }
+    return failures;
+}
+
+// ----------------------
+// --bench-circles
+// ----------------------
+// raster::circle per circle vs memoised rings + batched translate, for
+// batches of moon / asteroid style orbits. Returns the batches whose cached
+// pixels differ from raster::circle.
+inline int runCircleBenchmark() {
+    const size_t batchSizes[] = {100, 1000, 10000};
+    const int maxRadii[] = {8, 64, 256};
+    const int reps = 5;
+
+    std::printf("Circle batch benchmark (us per batch, best of %d)\n", reps);
+    std::printf("%8s %6s %10s %10s %10s %8s %6s\n", "circles", "r<=", "midpoint",
+                "cached", "cold cache", "points", "exact");
+
+    int failures = 0;
+    for (size_t n : batchSizes) {
+        for (int maxR : maxRadii) {
+            StarRng rng(3);
+            std::vector<CircleSpec> circles(n);
+            for (CircleSpec& c : circles) {
+                c.xc = (int)rng.range(-500.0f, 500.0f);
+                c.yc = (int)rng.range(-500.0f, 500.0f);
+                c.r = 1 + (int)rng.range(0.0f, (float)maxR);
+            }
+
+            std::vector<raster::Point> direct, batched;
+            raster::PointListSink sink(direct);
+            double directUs = 1e30, cachedUs = 1e30, coldUs = 1e30;
+            CircleCache cache;
+            for (int r = 0; r < reps; r++) {
+                Clock::time_point t = Clock::now();
+                direct.clear();
+                for (const CircleSpec& c : circles) raster::circle(c.xc, c.yc, c.r, sink);
+                directUs = std::min(directUs, elapsedUs(t));
+
+                CircleCache cold;
+                std::vector<raster::Point> scratch;
+                t = Clock::now();
+                cold.appendBatch(circles.data(), n, scratch);
+                coldUs = std::min(coldUs, elapsedUs(t));
+
+                t = Clock::now();
+                batched.clear();
+                cache.appendBatch(circles.data(), n, batched);
+                cachedUs = std::min(cachedUs, elapsedUs(t));
+            }
+            std::printf("%8zu %6d %10.1f %10.1f %10.1f %8zu %6s\n", n, maxR, directUs, cachedUs,
+                        coldUs, batched.size(), batched == direct ? "yes" : "NO");
+            if (!(batched == direct)) failures++;
+        }
+    }
+    return failures;
+}
+
+// ----------------------
+// --bench-ellipses
+// ----------------------
+// Batched midpoint orbits (orbit_batch.h) vs generic parametric sampling,
+// x = a cos t, y = b sin t rotated and rounded, with the sample count tied to
+// the perimeter. "gaps" counts places where the pixel path jumps more than
+// one pixel (the joins between raster::orbit's four chains excepted); "err"
+// is the mean and worst pixel distance from the true curve. Returns the
+// midpoint batches with gaps or a pixel further than kOrbitMaxError out.
+
+// Midpoint ellipse pixels lie a little over half a pixel from the curve, and
+// rounding rotated points adds up to sqrt(2) / 2
+const double kOrbitMaxError = 1.25;
+
+// Parametric reference; `density` samples per unit of perimeter
+inline void parametricOrbit(const OrbitShape& s, float density, std::vector<raster::Point>& out) {
+    float a = (float)s.a, b = (float)s.b;
+    float h = (a - b) * (a - b) / std::max((a + b) * (a + b), 1e-6f);
+    float perimeter = 3.14159265f * (a + b) * (1 + 3 * h / (10 + std::sqrt(4 - 3 * h)));
+    int samples = std::max(4, (int)std::ceil(perimeter * density));
+    float cr = s.rot.c / 16384.0f, sr = s.rot.s / 16384.0f;
+    raster::Point last = {-(1 << 30), 0};
+    for (int i = 0; i < samples; i++) {
+        float t = 6.2831853f * i / samples;
+        float x = a * std::cos(t) - s.c, y = b * std::sin(t);
+        raster::Point p = {s.xf + (int)std::lround(x * cr - y * sr),
+                           s.yf + (int)std::lround(x * sr + y * cr)};
+        if (!(p == last)) out.push_back(p);
+        last = p;
+    }
+}
+
+struct OrbitQuality {
+    size_t gaps = 0, pixels = 0;
+    double errSum = 0, errMax = 0;
+};
+
+// Distance from (x, y), both >= 0, to the ellipse with semi-axes a >= b > 0
+// (Eberly's root of the normal's parameter, by Newton steps that fall back
+// to bisection when they leave the bracket or stall near its pole)
+inline double ellipseDistance(double a, double b, double x, double y) {
+    if (y <= 0) {
+        // On the major axis: the nearest point is the vertex or off-axis
+        double along = a * x, span = a * a - b * b;
+        if (along >= span) return std::fabs(x - a);
+        double t = along / span;
+        return std::hypot(a * t - x, b * std::sqrt(1 - t * t));
+    }
+    if (x <= 0) return std::fabs(y - b);
+    double r = (a / b) * (a / b), z0 = x / a, z1 = y / b;
+    double g = z0 * z0 + z1 * z1 - 1;
+    if (g == 0) return 0;
+    double s0 = z1 - 1, s1 = g < 0 ? 0 : std::hypot(r * z0, z1) - 1, s = s0;
+    for (int i = 0; i < 64 && s1 - s0 > 1e-12 * (1 + std::fabs(s)); i++) {
+        double n0 = r * z0 / (s + r), n1 = z1 / (s + 1);
+        double f = n0 * n0 + n1 * n1 - 1;
+        if (f > 0) s0 = s;
+        else if (f < 0) s1 = s;
+        else break;
+        double next = s + f / (2 * (n0 * n0 / (s + r) + n1 * n1 / (s + 1)));
+        s = (next > s0 && next < s1 && std::fabs(next - s) < 0.5 * (s1 - s0)) ? next : 0.5 * (s0 + s1);
+    }
+    return std::hypot(r * x / (s + r) - x, y / (s + 1) - y);
+}
+
+// Accumulate the quality of one orbit's pixels [begin, end)
+inline void orbitQuality(const OrbitShape& s, const raster::Point* begin, const raster::Point* end,
+                         int allowedJumps, OrbitQuality& q) {
+    int jumps = 0;
+    for (const raster::Point* p = begin + 1; p < end; ++p)
+        if (std::max(std::abs(p->x - p[-1].x), std::abs(p->y - p[-1].y)) > 1) jumps++;
+    q.gaps += std::max(0, jumps - allowedJumps);
+
+    // Distance in the ellipse frame (centred, major axis along x)
+    double cr = s.rot.c / 16384.0, sr = s.rot.s / 16384.0;
+    double a = std::max(s.a, 1), b = std::min(std::max(s.b, 1), std::max(s.a, 1));
+    for (const raster::Point* p = begin; p != end; ++p) {
+        double dx = p->x - s.xf, dy = p->y - s.yf;
+        double e = ellipseDistance(a, b, std::fabs(dx * cr + dy * sr + s.c), std::fabs(-dx * sr + dy * cr));
+        q.errSum += e;
+        q.errMax = std::max(q.errMax, e);
+        q.pixels++;
+    }
+}
+
+inline int runEllipseBenchmark() {
+    struct Population {
+        const char* name;
+        float minA, maxA, minE, maxE;
+    };
+    const Population populations[] = {
+        {"asteroids", 32, 42, 0.0f, 0.3f},     // between the Mars and Jupiter orbits
+        {"comets", 20, 400, 0.5f, 0.97f},
+    };
+    const size_t counts[] = {1000, 10000};
+    const int reps = 5;
+
+    std::printf("Orbit batch benchmark (ms per batch, best of %d)\n", reps);
+    std::printf("%10s %7s %-16s %9s %9s %7s %9s %8s\n", "population", "orbits", "method", "ms",
+                "points", "gaps", "mean err", "max err");
+
+    int failures = 0;
+    for (const Population& pop : populations) {
+        for (size_t n : counts) {
+            StarRng rng(11);
+            std::vector<OrbitShape> shapes(n);
+            for (OrbitShape& s : shapes) {
+                OrbitElements e;
+                e.semiMajor = rng.range(pop.minA, pop.maxA);
+                e.eccentricity = rng.range(pop.minE, pop.maxE);
+                e.periapsis = rng.range(0.0f, 6.2831853f);
+                e.focusX = e.focusY = 0;
+                s = orbitShape(e);
+            }
+
+            for (int method = 0; method < 3; method++) {
+                const char* names[] = {"midpoint batch", "parametric 1x", "parametric 2x"};
+                std::vector<raster::Point> points;
+                std::vector<uint32_t> firsts;
+                double ms = 1e30;
+                for (int r = 0; r < reps; r++) {
+                    points.clear();
+                    firsts.clear();
+                    Clock::time_point t = Clock::now();
+                    if (method == 0) {
+                        appendOrbits(shapes.data(), n, points, firsts);
+                    } else {
+                        firsts.push_back(0);
+                        for (const OrbitShape& s : shapes) {
+                            parametricOrbit(s, (float)method, points);
+                            firsts.push_back((uint32_t)points.size());
+                        }
+                    }
+                    ms = std::min(ms, elapsedUs(t) / 1000.0);
+                }
+
+                OrbitQuality q;
+                for (size_t i = 0; i < n; i++)
+                    orbitQuality(shapes[i], points.data() + firsts[i], points.data() + firsts[i + 1],
+                                 method == 0 ? 3 : 0, q);
+                std::printf("%10s %7zu %-16s %9.2f %9zu %7zu %9.2f %8.2f\n", pop.name, n,
+                            names[method], ms, points.size(), q.gaps, q.errSum / q.pixels, q.errMax);
+                if (method == 0 && (q.gaps > 0 || q.errMax > kOrbitMaxError)) failures++;
+            }
+        }
+    }
+    std::printf("Midpoint batch (no gaps, max err <= %.2f px): %s (%d failures)\n", kOrbitMaxError,
+                failures ? "FAILED" : "ok", failures);
+    return failures;
+}
+
+// ----------------------
+// --bench-wu
+// ----------------------
+// Xiaolin Wu anti-aliased lines against the Bresenham paths: throughput into
+// point lists and a CPU framebuffer, and how the output compares ("agree" is
+// the share of steps where Bresenham's pixel is Wu's heavier one, ties
+// included, "coverage" the summed Wu weight per Bresenham pixel).
+inline void runWuBenchmark() {
+    const int lengths[] = {16, 64, 256};
+    const size_t n = 10000;
+    const int reps = 5;
+    const int size = 2048;
+    std::vector<uint32_t> pixels((size_t)size * size, 0xFF000000u);
+    raster::FramebufferSink<uint32_t> fbSink(pixels.data(), size, size, 0xFFFFFFFFu);
+
+    std::printf("Wu vs Bresenham (%zu segments, ms per batch, best of %d)\n", n, reps);
+    std::printf("%6s %10s %10s %10s %10s %10s %8s %8s %9s\n", "length", "bres pts", "bres spans",
+                "wu pts", "bres fb", "wu fb", "wu/bres", "agree", "coverage");
+
+    for (int length : lengths) {
+        StarRng rng(17);
+        std::vector<LineSegment> segs(n);
+        for (LineSegment& s : segs) {
+            s.x0 = (int)rng.range(length, size - length);
+            s.y0 = (int)rng.range(length, size - length);
+            float a = rng.range(0.0f, 6.2831853f);
+            s.x1 = s.x0 + (int)(length * std::cos(a));
+            s.y1 = s.y0 + (int)(length * std::sin(a));
+        }
+
+        std::vector<raster::Point> points;
+        std::vector<LineSpan> spans;
+        std::vector<raster::CoveragePoint> covered;
+        raster::PointListSink pointSink(points);
+        raster::CoverageListSink coverageSink(covered);
+        double t[5] = {1e30, 1e30, 1e30, 1e30, 1e30};
+        for (int r = 0; r < reps; r++) {
+            Clock::time_point start = Clock::now();
+            points.clear();
+            for (const LineSegment& s : segs) raster::line(s.x0, s.y0, s.x1, s.y1, pointSink);
+            t[0] = std::min(t[0], elapsedUs(start) / 1000.0);
+
+            start = Clock::now();
+            spans.clear();
+            for (const LineSegment& s : segs) raster::lineSpans(s.x0, s.y0, s.x1, s.y1, spans);
+            t[1] = std::min(t[1], elapsedUs(start) / 1000.0);
+
+            start = Clock::now();
+            covered.clear();
+            for (const LineSegment& s : segs) raster::wuLine(s.x0, s.y0, s.x1, s.y1, coverageSink);
+            t[2] = std::min(t[2], elapsedUs(start) / 1000.0);
+
+            start = Clock::now();
+            for (const LineSegment& s : segs) raster::line(s.x0, s.y0, s.x1, s.y1, fbSink);
+            t[3] = std::min(t[3], elapsedUs(start) / 1000.0);
+
+            start = Clock::now();
+            for (const LineSegment& s : segs) raster::wuLine(s.x0, s.y0, s.x1, s.y1, fbSink);
+            t[4] = std::min(t[4], elapsedUs(start) / 1000.0);
+        }
+
+        // Per segment, walk both outputs a major-axis step at a time
+        size_t steps = 0, agree = 0;
+        double weight = 0;
+        for (const LineSegment& s : segs) {
+            points.clear();
+            covered.clear();
+            raster::line(s.x0, s.y0, s.x1, s.y1, pointSink);
+            raster::wuLine(s.x0, s.y0, s.x1, s.y1, coverageSink);
+            bool steep = std::abs(s.y1 - s.y0) > std::abs(s.x1 - s.x0);
+            size_t c = 0;
+            for (const raster::Point& b : points) {
+                int major = steep ? b.y : b.x;
+                int heaviest = 0, atBresenham = 0;
+                for (; c < covered.size() && (steep ? covered[c].y : covered[c].x) == major; c++) {
+                    heaviest = std::max(heaviest, covered[c].weight);
+                    if (covered[c].x == b.x && covered[c].y == b.y) atBresenham = covered[c].weight;
+                    weight += covered[c].weight / 255.0;
+                }
+                if (atBresenham >= heaviest - 1) agree++;   // exact half-pixel ties go either way
+                steps++;
+            }
+        }
+        std::printf("%6d %10.3f %10.3f %10.3f %10.3f %10.3f %7.2fx %7.1f%% %9.3f\n", length, t[0],
+                    t[1], t[2], t[3], t[4], t[2] / t[0], 100.0 * agree / steps, weight / steps);
+    }
+}
+
+// ----------------------
+// --bench-transform
+// ----------------------
+// Checks the transform library against plain scalar loops and the GL
+// definitions, then times each batch kernel against the plain loop for the
+// same job ("ref"). At -O2 recent GCC vectorises those loops too, so the
+// AoS kernels only match them; the SoA kernel is the fast one while the
+// batch fits in cache, and past that every kernel waits on memory.
+inline bool nearlyEqual(const Mat4& a, const Mat4& b, float eps) {
+    for (int i = 0; i < 16; i++)
+        if (std::fabs(a.m[i] - b.m[i]) > eps) return false;
+    return true;
+}
+
+inline bool nearlyEqual(const Vec3& a, const Vec3& b, float eps) {
+    return std::fabs(a.x - b.x) <= eps && std::fabs(a.y - b.y) <= eps && std::fabs(a.z - b.z) <= eps;
+}
+
+inline Mat4 randomMatrix(StarRng& rng) {
+    Vec3 axis{rng.range(-1, 1), rng.range(-1, 1), rng.range(0.1f, 1)};
+    return Mat4::translation(Vec3{rng.range(-50, 50), rng.range(-50, 50), rng.range(-50, 50)}) *
+           Mat4::rotation(rng.range(-180, 180), axis) *
+           Mat4::scaling(Vec3{rng.range(0.2f, 3), rng.range(0.2f, 3), rng.range(0.2f, 3)});
+}
+
+// Returns the number of failed checks
+inline int verifyTransform() {
+    int failures = 0;
+    StarRng rng(11);
+
+    for (int t = 0; t < 1000; t++) {
+        Mat4 a = randomMatrix(rng), b = randomMatrix(rng);
+        if (t & 1) a = perspective(rng.range(10, 120), rng.range(0.5f, 2), 1, 1000) * a;
+
+        // Product against the textbook triple loop
+        Mat4 ab = a * b, expected;
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++) {
+                float sum = 0;
+                for (int k = 0; k < 4; k++) sum += a.at(r, k) * b.at(k, c);
+                expected.at(r, c) = sum;
+            }
+        if (!nearlyEqual(ab, expected, 1e-3f)) failures++;
+
+        // Inverse round trip, transpose twice
+        if (!nearlyEqual(a * a.inverse(), Mat4::identity(), 1e-4f)) failures++;
+        if (!nearlyEqual(a.transposed().transposed(), a, 0.0f)) failures++;
+
+        // Normals stay perpendicular to surface vectors
+        Vec3 n{rng.range(-1, 1), rng.range(-1, 1), 1}, tangent = cross(n, Vec3{1, 0, 0});
+        if (std::fabs(dot(normalize(b.normalMatrix().transformDirection(n)),
+                          normalize(b.transformDirection(tangent)))) > 1e-4f) failures++;
+
+        // Quaternions agree with glRotatef matrices and compose the same way
+        float angleA = rng.range(-180, 180), angleB = rng.range(-180, 180);
+        Vec3 axisA{rng.range(-1, 1), rng.range(-1, 1), 0.5f}, axisB{0.3f, rng.range(-1, 1), rng.range(-1, 1)};
+        Quat qa = Quat::fromAxisAngle(angleA, axisA), qb = Quat::fromAxisAngle(angleB, axisB);
+        Mat4 ra = Mat4::rotation(angleA, axisA), rb = Mat4::rotation(angleB, axisB);
+        if (!nearlyEqual(qa.toMat4(), ra, 1e-5f)) failures++;
+        if (!nearlyEqual((qa * qb).toMat4(), ra * rb, 1e-5f)) failures++;
+        Vec3 v{rng.range(-10, 10), rng.range(-10, 10), rng.range(-10, 10)};
+        if (!nearlyEqual(qa.rotate(v), ra.transformDirection(v), 1e-4f)) failures++;
+
+        // slerp hits both ends and halves the angle in the middle
+        Quat half = slerp(Quat::identity(), qa, 0.5f);
+        if (!nearlyEqual(slerp(qa, qb, 0.0f).toMat4(), qa.toMat4(), 1e-5f) ||
+            !nearlyEqual(slerp(qa, qb, 1.0f).toMat4(), qb.toMat4(), 1e-5f) ||
+            !nearlyEqual((half * half).toMat4(), ra, 1e-4f)) failures++;
+    }
+
+    // gluLookAt puts the eye at the origin looking down -z with +y up
+    Vec3 eye{10, 25, 60}, centre{10 + 60 * std::sin(0.3f), 0, 60 - 60 * std::cos(0.3f)};
+    Mat4 view = lookAt(eye, centre, Vec3{0, 1, 0});
+    Vec3 e = view.transformPoint(eye), c = view.transformPoint(centre);
+    if (!nearlyEqual(e, Vec3{0, 0, 0}, 1e-4f)) failures++;
+    if (!nearlyEqual(c, Vec3{0, 0, -length(centre - eye)}, 1e-3f)) failures++;
+    if (view.transformDirection(Vec3{0, 1, 0}).y <= 0) failures++;
+
+    // gluPerspective maps the near / far planes to -1 / +1 and the fov edge to y = 1
+    Mat4 proj = perspective(60, 4.0f / 3.0f, 1, 1000);
+    Vec4 nearPoint = proj * Vec4{0, 0, -1, 1}, farPoint = proj * Vec4{0, 0, -1000, 1};
+    Vec4 edge = proj * Vec4{0, std::tan(3.14159265f / 6), -1, 1};
+    if (std::fabs(nearPoint.project().z + 1) > 1e-4f || std::fabs(farPoint.project().z - 1) > 1e-3f ||
+        std::fabs(edge.project().y - 1) > 1e-4f) failures++;
+
+    // Batch kernels against Mat4 * Vec4, odd count so every tail path runs
+    const size_t n = 1003;
+    Mat4 m = proj * view;
+    std::vector<Vec3> points(n);
+    std::vector<float> x(n), y(n), z(n), ox(n), oy(n), oz(n), ow(n);
+    for (size_t i = 0; i < n; i++) {
+        points[i] = Vec3{rng.range(-100, 100), rng.range(-100, 100), rng.range(-100, 100)};
+        x[i] = points[i].x;
+        y[i] = points[i].y;
+        z[i] = points[i].z;
+    }
+    std::vector<Vec4> clip(n);
+    std::vector<Vec3> affine(n);
+    transformPoints(m, points.data(), clip.data(), n);
+    transformPointsAffine(view, points.data(), affine.data(), n);
+    transformPoints(m, x.data(), y.data(), z.data(), n, ox.data(), oy.data(), oz.data(), ow.data());
+    int batchFailures = 0;
+    for (size_t i = 0; i < n; i++) {
+        Vec4 r = m * Vec4{points[i].x, points[i].y, points[i].z, 1};
+        Vec3 a = view.transformPoint(points[i]);
+        if (std::fabs(clip[i].x - r.x) > 1e-3f || std::fabs(clip[i].w - r.w) > 1e-3f ||
+            !nearlyEqual(affine[i], a, 1e-3f) || std::fabs(ox[i] - r.x) > 1e-3f ||
+            std::fabs(oy[i] - r.y) > 1e-3f || std::fabs(oz[i] - r.z) > 1e-3f ||
+            std::fabs(ow[i] - r.w) > 1e-3f) batchFailures = 1;
+    }
+    return failures + batchFailures;
+}
+
+// Returns the verification failures
+inline int runTransformBenchmark() {
+    int failures = verifyTransform();
+    std::printf("Transform library vs scalar / GL definitions: %s (%d failures)\n",
+                failures ? "FAILED" : "ok", failures);
+
+    const size_t counts[] = {1000, 100000, 1000000};
+    const int reps = 5;
+    Mat4 m = perspective(60, 4.0f / 3.0f, 1, 1000) * lookAt(Vec3{10, 25, 60}, Vec3{10, 0, 0}, Vec3{0, 1, 0});
+
+    std::printf("Batch transforms (ns per point, best of %d)\n", reps);
+    std::printf("%10s %10s %10s %10s %10s %10s %10s %8s\n", "points", "aos ref", "aos", "affine ref", "affine",
+                "soa ref", "soa", "soa x");
+    for (size_t n : counts) {
+        StarRng rng(3);
+        std::vector<Vec3> points(n), affine(n);
+        std::vector<Vec4> clip(n);
+        std::vector<float> x(n), y(n), z(n), ox(n), oy(n), oz(n), ow(n);
+        for (size_t i = 0; i < n; i++) {
+            points[i] = Vec3{rng.range(-100, 100), rng.range(-100, 100), rng.range(-100, 100)};
+            x[i] = points[i].x;
+            y[i] = points[i].y;
+            z[i] = points[i].z;
+        }
+
+        double t[6] = {1e30, 1e30, 1e30, 1e30, 1e30, 1e30};
+        const float* a = m.m;
+        for (int r = 0; r < reps; r++) {
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < n; i++) {
+                const Vec3& p = points[i];
+                clip[i] = Vec4{a[0] * p.x + a[4] * p.y + a[8] * p.z + a[12],
+                               a[1] * p.x + a[5] * p.y + a[9] * p.z + a[13],
+                               a[2] * p.x + a[6] * p.y + a[10] * p.z + a[14],
+                               a[3] * p.x + a[7] * p.y + a[11] * p.z + a[15]};
+            }
+            t[0] = std::min(t[0], elapsedUs(start));
+
+            start = Clock::now();
+            transformPoints(m, points.data(), clip.data(), n);
+            t[1] = std::min(t[1], elapsedUs(start));
+
+            start = Clock::now();
+            for (size_t i = 0; i < n; i++) affine[i] = m.transformPoint(points[i]);
+            t[2] = std::min(t[2], elapsedUs(start));
+
+            start = Clock::now();
+            transformPointsAffine(m, points.data(), affine.data(), n);
+            t[3] = std::min(t[3], elapsedUs(start));
+
+            start = Clock::now();
+            for (size_t i = 0; i < n; i++) {
+                float px = x[i], py = y[i], pz = z[i];
+                ox[i] = a[0] * px + a[4] * py + a[8] * pz + a[12];
+                oy[i] = a[1] * px + a[5] * py + a[9] * pz + a[13];
+                oz[i] = a[2] * px + a[6] * py + a[10] * pz + a[14];
+                ow[i] = a[3] * px + a[7] * py + a[11] * pz + a[15];
+            }
+            t[4] = std::min(t[4], elapsedUs(start));
+
+            start = Clock::now();
+            transformPoints(m, x.data(), y.data(), z.data(), n, ox.data(), oy.data(), oz.data(), ow.data());
+            t[5] = std::min(t[5], elapsedUs(start));
+        }
+        std::printf("%10zu", n);
+        for (double us : t) std::printf(" %10.2f", us * 1000 / n);
+        std::printf(" %7.2fx\n", t[4] / t[5]);
+    }    return failures;
+}
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,70 @@
+// ======================
+// Camera - view / projection matrices, frustum and bounding cone
+// ======================
+
+#include "camera.h"
+
+#include <algorithm>
+
+static const float kDegToRad = 3.14159265358979f / 180.0f;
+
+void Camera::reset() {
+    position = Vec3{10, 25, 60};
+    yaw = 0.0f;
+    // The original view looked 25 units down for every 60 units ahead.
+    // Computed here, not in a static, as the global camera is constructed
+    // before other translation units' dynamic initialisers may have run.
+    pitch = -std::atan2(25.0f, 60.0f) / kDegToRad;
+    snap();
+}
+
+Vec3 Camera::direction(float yawDegrees, float pitchDegrees) {
+    float y = yawDegrees * kDegToRad, p = pitchDegrees * kDegToRad;
+    return Vec3{std::sin(y) * std::cos(p), std::sin(p), -std::cos(y) * std::cos(p)};
+}
+
+Vec3 Camera::forward() const { return direction(yaw, pitch); }
+
+Quat Camera::orientation() const {
+    // Yaw turns right, which is clockwise seen from above (negative about +y)
+    return Quat::fromAxisAngle(-yaw, Vec3{0, 1, 0}) * Quat::fromAxisAngle(pitch, Vec3{1, 0, 0});
+}
+
+void Camera::update(float alpha) {
+    Pose p{position, yaw, pitch};
+    if (alpha < 1.0f) {
+        p.position = previous.position + (position - previous.position) * alpha;
+        p.yaw = previous.yaw + (yaw - previous.yaw) * alpha;
+        p.pitch = previous.pitch + (pitch - previous.pitch) * alpha;
+    }
+    Vec3 dir = direction(p.yaw, p.pitch);
+    view = lookAt(p.position, p.position + dir, Vec3{0, 1, 0});
+    projection = perspective(fovY, aspect, zNear, zFar);
+    combined = projection * view;
+    planes.fromMatrix(combined.data());
+
+    // Half-angle to the frustum's corner rays
+    float tanY = std::tan(fovY * kDegToRad * 0.5f), tanX = tanY * aspect;
+    float tanDiagonal = std::sqrt(tanX * tanX + tanY * tanY);
+    float inv = 1.0f / std::sqrt(1.0f + tanDiagonal * tanDiagonal);
+    bounds.apex = p.position;
+    bounds.axis = dir;
+    bounds.cosAngle = inv;
+    bounds.sinAngle = tanDiagonal * inv;
+    bounds.farDistance = zFar;
+}
+
+bool ViewCone::intersectsSphere(const Vec3& centre, float radius) const {
+    Vec3 v = centre - apex;
+    float along = dot(v, axis);
+    if (along - radius > farDistance) return false;
+    // Signed distance to the cone's side in the plane through the axis; it
+    // never exceeds the true distance, so nothing visible is rejected
+    float across = std::sqrt(std::max(0.0f, dot(v, v) - along * along));
+    return cosAngle * across - sinAngle * along <= radius;
+}
+
+bool Camera::sphereVisible(const Vec3& centre, float radius) const {
+    if (!bounds.intersectsSphere(centre, radius)) return false;
+    return planes.testSphere(centre.x, centre.y, centre.z, radius) != FRUSTUM_OUTSIDE;
+}
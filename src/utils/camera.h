@@ -0,0 +1,88 @@
+// ======================
+// Camera
+// ======================
+// Owns the viewer's position and orientation and everything derived from
+// them: the view matrix (gluLookAt), the projection (gluPerspective), the
+// six frustum planes and a bounding cone. update() rebuilds the derived
+// state once per frame, so culling code asks the camera instead of reading
+// matrices back from GL with glGetFloatv.
+//
+// Orientation is yaw about +y (0 looks down -z, positive turns right, the
+// Q/E keys) and pitch (negative looks down). Movement stays along the world
+// axes, as the keyboard controls always worked.
+//
+// For fixed-timestep simulation the camera remembers its pose at the start
+// of the latest step; update(alpha) renders that fraction of the way from
+// it to the current pose, so motion stays smooth between steps.
+
+#ifndef COSMIC_CAMERA_H
+#define COSMIC_CAMERA_H
+
+#include "frustum.h"
+#include "transform.h"
+
+// Cone from the eye that encloses the whole frustum. One dot product rejects
+// most off-screen objects before the six-plane test.
+struct ViewCone {
+    Vec3 apex, axis;            // axis is unit length
+    float cosAngle, sinAngle;   // half-angle, out to the frustum's corners
+    float farDistance;          // along the axis
+
+    // Directions (unit vectors) for objects at infinity, like catalog stars
+    bool containsDirection(const Vec3& d) const { return dot(d, axis) >= cosAngle; }
+    // Conservative: may keep a sphere just outside, never drops one inside
+    bool intersectsSphere(const Vec3& centre, float radius) const;
+};
+
+class Camera {
+public:
+    Vec3 position;
+    float yaw, pitch;           // degrees
+    float fovY = 60.0f;         // vertical, degrees (Z/X zoom)
+    float aspect = 4.0f / 3.0f;
+    float zNear = 1.0f, zFar = 1000.0f;
+
+    Camera() { reset(); }
+
+    // The start-up position and orientation: above and behind the floor,
+    // looking slightly down (the zoom is left alone)
+    void reset();
+
+    void translate(const Vec3& d) { position += d; }
+    void turn(float degrees) { yaw += degrees; }
+
+    // Call before each simulation step moves the camera
+    void beginStep() { previous = Pose{position, yaw, pitch}; }
+    // Drop the interpolation after a jump (reset, command line)
+    void snap() { beginStep(); }
+
+    Vec3 forward() const;       // unit view direction
+    Quat orientation() const;   // rotates -z onto forward()
+
+    // Recompute matrices, frustum and cone; call after changing the fields.
+    // alpha < 1 blends from the pose at beginStep() to the current one.
+    void update(float alpha = 1.0f);
+
+    const Mat4& viewMatrix() const { return view; }
+    const Mat4& projectionMatrix() const { return projection; }
+    const Mat4& viewProjection() const { return combined; }
+    const Frustum& frustum() const { return planes; }
+    const ViewCone& cone() const { return bounds; }
+
+    // Cone first, then the planes
+    bool sphereVisible(const Vec3& centre, float radius) const;
+
+private:
+    struct Pose {
+        Vec3 position;
+        float yaw, pitch;
+    };
+    static Vec3 direction(float yawDegrees, float pitchDegrees);
+
+    Pose previous;
+    Mat4 view, projection, combined;
+    Frustum planes;
+    ViewCone bounds;
+};
+
+#endif
@@ -0,0 +1,122 @@
+// ======================
+// Memoised Midpoint Circles
+// ======================
+// The midpoint loop only depends on the radius, so it runs once per radius:
+// the octant (x <= y) is stored, expanded once into the full 8-way ring of
+// offsets, and every circle of that radius is just the ring translated to
+// its centre. The translate is a flat add over interleaved ints, which the
+// compiler vectorises.
+//
+// Output order matches raster::circle exactly, so cached and uncached
+// circles are interchangeable pixel for pixel.
+
+#ifndef COSMIC_CIRCLE_CACHE_H
+#define COSMIC_CIRCLE_CACHE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "../algorithms/raster.h"
+
+struct CircleSpec {
+    int xc, yc, r;
+};
+
+class CircleCache {
+public:
+    struct Stats {
+        size_t hits = 0, misses = 0;
+    };
+
+    // One octant of radius r: the (x, y) pairs of the midpoint loop, x <= y
+    const std::vector<raster::Point>& octant(int r) { return entry(r).octant; }
+
+    // All 8 octants as offsets from the centre, in raster::circle order
+    const std::vector<raster::Point>& ring(int r) { return entry(r).ring; }
+
+    // Append one circle; returns the number of points written
+    size_t append(int xc, int yc, int r, std::vector<raster::Point>& out) {
+        const std::vector<raster::Point>& offsets = ring(r);
+        size_t base = out.size();
+        out.resize(base + offsets.size());
+        translate(offsets.data(), offsets.size(), xc, yc, out.data() + base);
+        return offsets.size();
+    }
+
+    // Append many circles with a single resize of the output buffer
+    void appendBatch(const CircleSpec* circles, size_t count, std::vector<raster::Point>& out) {
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) total += ring(circles[i].r).size();
+        size_t at = out.size();
+        out.resize(at + total);
+        for (size_t i = 0; i < count; i++) {
+            const std::vector<raster::Point>& offsets = entry(circles[i].r).ring;
+            translate(offsets.data(), offsets.size(), circles[i].xc, circles[i].yc, out.data() + at);
+            at += offsets.size();
+        }
+    }
+
+    // Through any raster sink (e.g. FloorPlaneSink)
+    template <typename Sink>
+    void draw(int xc, int yc, int r, Sink& sink) {
+        for (const raster::Point& p : ring(r)) sink.point(p.x + xc, p.y + yc);
+    }
+
+    size_t radiusCount() const { return entries.size(); }
+    const Stats& statistics() const { return stats; }
+    void clear() { entries.clear(); }
+
+    static void translate(const raster::Point* offsets, size_t count, int xc, int yc,
+                          raster::Point* out) {
+        static_assert(sizeof(raster::Point) == 2 * sizeof(int), "Point must be two packed ints");
+        if (count == 0) return;
+        const int* src = &offsets[0].x;
+        int* dst = &out[0].x;
+        for (size_t i = 0; i < count; i++) {
+            dst[2 * i] = src[2 * i] + xc;
+            dst[2 * i + 1] = src[2 * i + 1] + yc;
+        }
+    }
+
+private:
+    struct Entry {
+        std::vector<raster::Point> octant;
+        std::vector<raster::Point> ring;
+    };
+
+    Entry& entry(int r) {
+        std::unordered_map<int, Entry>::iterator it = entries.find(r);
+        if (it != entries.end()) {
+            stats.hits++;
+            return it->second;
+        }
+        stats.misses++;
+        Entry& e = entries[r];
+
+        int x = 0, y = r;
+        int d = 1 - r;
+        while (x <= y) {
+            e.octant.push_back(raster::Point{x, y});
+            if (d < 0) {
+                d += 2 * x + 3;
+            } else {
+                d += 2 * (x - y) + 5;
+                y--;
+            }
+            x++;
+        }
+
+        e.ring.reserve(e.octant.size() * 8);
+        for (const raster::Point& p : e.octant) {
+            raster::Point sym[8] = {{p.x, p.y}, {-p.x, p.y}, {p.x, -p.y}, {-p.x, -p.y},
+                                    {p.y, p.x}, {-p.y, p.x}, {p.y, -p.x}, {-p.y, -p.x}};
+            e.ring.insert(e.ring.end(), sym, sym + 8);
+        }
+        return e;
+    }
+
+    std::unordered_map<int, Entry> entries;
+    Stats stats;
+};
+
+#endif
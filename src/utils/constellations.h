@@ -0,0 +1,156 @@
+// ======================
+// Constellation Figures
+// ======================
+// Stick figures are data, not code: each figure is a list of line segments
+// between stars identified by Hipparcos number, read from a text file.
+//
+//   star <hip> <x> <z> <r> <g> <b>    floor chart position and colour
+//   color <abbr> <r> <g> <b>          figure colour (optional)
+//   <abbr> <n> <hip> <hip> ...        n segments as hip pairs
+//
+// The segment lines use the layout of Stellarium's constellationship.fab,
+// so the full set of 88 IAU figures can be merged in from that file. The
+// floor chart draws the segments whose stars have chart positions; with a
+// star catalog loaded every figure is also drawn on the sky sphere.
+//
+// Figures keep the vertex range they were baked into, so any subset draws
+// with one glMultiDrawArrays.
+
+#ifndef COSMIC_CONSTELLATIONS_H
+#define COSMIC_CONSTELLATIONS_H
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gl_ext.h"
+
+struct ChartStar {
+    uint32_t hip;
+    int x, z;
+    float color[3];
+};
+
+struct ConstellationFigure {
+    std::string name;                 // IAU abbreviation, or an asterism name
+    float color[3];
+    std::vector<uint32_t> segments;   // hip pairs
+    bool visible = true;
+    GLint floorFirst = 0, skyFirst = 0;    // ranges in the baked layers
+    GLsizei floorCount = 0, skyCount = 0;
+};
+
+// Distinct default colours for figures without a `color` line
+inline void defaultFigureColor(size_t index, float rgb[3]) {
+    float h = std::fmod(index * 0.618034f, 1.0f) * 6.0f;
+    float f = h - std::floor(h);
+    float v[6][3] = {{1, f, 0}, {1 - f, 1, 0}, {0, 1, f}, {0, 1 - f, 1}, {f, 0, 1}, {1, 0, 1 - f}};
+    const float* c = v[(int)h % 6];
+    for (int i = 0; i < 3; i++) rgb[i] = 0.45f + 0.55f * c[i];
+}
+
+class ConstellationSet {
+public:
+    std::vector<ConstellationFigure> figures;
+    std::vector<ChartStar> chartStars;      // in file order
+
+    // Parse a figure file; figures with an existing name are replaced, so a
+    // full constellationship.fab can be layered over the built-in chart.
+    bool load(const char* path) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cout << "WARN: constellation file not found: " << path << std::endl;
+            return false;
+        }
+
+        std::string line;
+        int lineNo = 0, loaded = 0;
+        while (std::getline(in, line)) {
+            lineNo++;
+            size_t hash = line.find('#');
+            if (hash != std::string::npos) line.erase(hash);
+            std::istringstream ss(line);
+            std::string head;
+            if (!(ss >> head)) continue;
+
+            if (head == "star") {
+                ChartStar s;
+                if (!(ss >> s.hip >> s.x >> s.z >> s.color[0] >> s.color[1] >> s.color[2])) {
+                    warn(path, lineNo);
+                    continue;
+                }
+                chartStars.push_back(s);
+            } else if (head == "color") {
+                std::string name;
+                float rgb[3];
+                if (!(ss >> name >> rgb[0] >> rgb[1] >> rgb[2])) {
+                    warn(path, lineNo);
+                    continue;
+                }
+                ConstellationFigure& fig = figure(name);
+                for (int i = 0; i < 3; i++) fig.color[i] = rgb[i];
+            } else {
+                int n = 0;
+                std::vector<uint32_t> segments;
+                uint32_t hip;
+                if (!(ss >> n)) { warn(path, lineNo); continue; }
+                while (ss >> hip) segments.push_back(hip);
+                if (n <= 0 || segments.size() != (size_t)n * 2) {
+                    warn(path, lineNo);
+                    continue;
+                }
+                figure(head).segments.swap(segments);
+                loaded++;
+            }
+        }
+        std::cout << "Constellations: " << loaded << " figures from " << path << "\n";
+        return true;
+    }
+
+    const ChartStar* findChartStar(uint32_t hip) const {
+        for (const ChartStar& s : chartStars)
+            if (s.hip == hip) return &s;
+        return nullptr;
+    }
+
+    ConstellationFigure* find(const std::string& name) {
+        for (ConstellationFigure& f : figures)
+            if (f.name == name) return &f;
+        return nullptr;
+    }
+
+    void setAllVisible(bool visible) {
+        for (ConstellationFigure& f : figures) f.visible = visible;
+    }
+
+    // Ranges of the visible figures in the floor (sky = false) or sky layer
+    void visibleRanges(bool sky, std::vector<GLint>& firsts, std::vector<GLsizei>& counts) const {
+        firsts.clear();
+        counts.clear();
+        for (const ConstellationFigure& f : figures) {
+            GLsizei n = sky ? f.skyCount : f.floorCount;
+            if (!f.visible || n == 0) continue;
+            firsts.push_back(sky ? f.skyFirst : f.floorFirst);
+            counts.push_back(n);
+        }
+    }
+
+private:
+    ConstellationFigure& figure(const std::string& name) {
+        if (ConstellationFigure* f = find(name)) return *f;
+        ConstellationFigure f;
+        f.name = name;
+        defaultFigureColor(figures.size(), f.color);
+        figures.push_back(f);
+        return figures.back();
+    }
+
+    static void warn(const char* path, int lineNo) {
+        std::cout << "WARN: " << path << ":" << lineNo << ": malformed line skipped\n";
+    }
+};
+
+#endif
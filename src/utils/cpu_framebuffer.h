@@ -0,0 +1,385 @@
+// ======================
+// CPU Framebuffer
+// ======================
+// An RGBA8 image in system memory for rendering without a GL context
+// (--render-overlay). Pixels are packed 0xAABBGGRR, so the bytes in memory
+// are R, G, B, A - the same layout as SceneVertex colours.
+//
+// Blending works a row at a time: SSE2 does four pixels per step, with a
+// scalar tail (and a scalar build when SSE2 is unavailable). Points are
+// drawn as splats - precomputed coverage masks per point size, square like
+// plain GL points or round with a soft edge like GL_POINT_SMOOTH.
+//
+// writePPM / writePNG save the image; PNG output uses stored (uncompressed)
+// deflate blocks, so no zlib is needed.
+
+#ifndef COSMIC_CPU_FRAMEBUFFER_H
+#define COSMIC_CPU_FRAMEBUFFER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "../algorithms/raster.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COSMIC_CPU_SSE2 1
+#endif
+
+inline uint32_t packRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16) | ((uint32_t)a << 24);
+}
+
+// ----------------------
+// Row blenders
+// ----------------------
+// dst[i] = lerp(dst[i], color, weight[i] * alpha), alpha in 0..256
+inline void blendRow(uint32_t* dst, const uint8_t* weight, int n, uint32_t color, int alpha) {
+    int i = 0;
+#ifdef COSMIC_CPU_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);   // 2 pixels, 16-bit
+    const __m128i a16 = _mm_set1_epi16((short)alpha);
+    const __m128i full = _mm_set1_epi16(256);
+    for (; i + 4 <= n; i += 4) {
+        int wbytes;
+        std::memcpy(&wbytes, weight + i, 4);
+        __m128i w = _mm_unpacklo_epi8(_mm_cvtsi32_si128(wbytes), zero);   // w0..w3
+        w = _mm_srli_epi16(_mm_mullo_epi16(w, a16), 8);                     // * alpha / 256
+        w = _mm_add_epi16(w, _mm_srli_epi16(w, 7));                        // 0..255 -> 0..256
+        w = _mm_unpacklo_epi16(w, w);                                       // w0 w0 w1 w1 ...
+        __m128i wlo = _mm_unpacklo_epi32(w, w), whi = _mm_unpackhi_epi32(w, w);
+
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i dlo = _mm_unpacklo_epi8(d, zero), dhi = _mm_unpackhi_epi8(d, zero);
+        // (d * (256 - w) + s * w) >> 8 stays within unsigned 16 bits
+        dlo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(dlo, _mm_sub_epi16(full, wlo)),
+                                           _mm_mullo_epi16(src, wlo)), 8);
+        dhi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(dhi, _mm_sub_epi16(full, whi)),
+                                           _mm_mullo_epi16(src, whi)), 8);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(dlo, dhi));
+    }
+#endif
+    for (; i < n; i++) {
+        int w = (weight[i] * alpha) >> 8;
+        if (w) dst[i] = raster::blendPixel(dst[i], color, w);
+    }
+}
+
+// dst[i] += color * weight[i] * alpha, saturating (additive blending)
+inline void addRow(uint32_t* dst, const uint8_t* weight, int n, uint32_t color, int alpha) {
+    int i = 0;
+#ifdef COSMIC_CPU_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+    const __m128i a16 = _mm_set1_epi16((short)alpha);
+    for (; i + 4 <= n; i += 4) {
+        int wbytes;
+        std::memcpy(&wbytes, weight + i, 4);
+        __m128i w = _mm_unpacklo_epi8(_mm_cvtsi32_si128(wbytes), zero);
+        w = _mm_srli_epi16(_mm_mullo_epi16(w, a16), 8);
+        w = _mm_add_epi16(w, _mm_srli_epi16(w, 7));
+        w = _mm_unpacklo_epi16(w, w);
+        __m128i wlo = _mm_unpacklo_epi32(w, w), whi = _mm_unpackhi_epi32(w, w);
+        __m128i slo = _mm_srli_epi16(_mm_mullo_epi16(src, wlo), 8);
+        __m128i shi = _mm_srli_epi16(_mm_mullo_epi16(src, whi), 8);
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epu8(d, _mm_packus_epi16(slo, shi)));
+    }
+#endif
+    for (; i < n; i++) {
+        int w = (weight[i] * alpha) >> 8;
+        w += w >> 7;
+        uint32_t out = 0;
+        for (int c = 0; c < 32; c += 8) {
+            uint32_t v = ((dst[i] >> c) & 0xFF) + ((((color >> c) & 0xFF) * w) >> 8);
+            out |= std::min(v, 255u) << c;
+        }
+        dst[i] = out;
+    }
+}
+
+// ----------------------
+// Framebuffer
+// ----------------------
+class CpuFramebuffer {
+public:
+    enum BlendMode { BLEND_ALPHA, BLEND_ADD };
+
+    void resize(int w, int h) {
+        width = w;
+        height = h;
+        pixels.assign((size_t)w * h, 0);
+    }
+
+    void clear(uint32_t color) { std::fill(pixels.begin(), pixels.end(), color); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    uint32_t* data() { return pixels.data(); }
+    const uint32_t* data() const { return pixels.data(); }
+
+    // Point of `size` pixels centred on (x, y); alpha 0..255
+    void splat(float x, float y, float size, bool smooth, uint32_t color, int alpha, BlendMode mode) {
+        const Splat& s = splatFor(size, smooth);
+        int x0 = (int)std::floor(x - s.side * 0.5f + 0.5f);
+        int y0 = (int)std::floor(y - s.side * 0.5f + 0.5f);
+        int cx0 = std::max(x0, 0), cx1 = std::min(x0 + s.side, width);
+        int cy0 = std::max(y0, 0), cy1 = std::min(y0 + s.side, height);
+        if (cx0 >= cx1 || cy0 >= cy1) return;
+        int a = alpha + (alpha >> 7);
+        for (int py = cy0; py < cy1; py++) {
+            const uint8_t* mask = &s.mask[(size_t)(py - y0) * s.side + (cx0 - x0)];
+            uint32_t* row = &pixels[(size_t)py * width + cx0];
+            if (mode == BLEND_ADD) addRow(row, mask, cx1 - cx0, color, a);
+            else blendRow(row, mask, cx1 - cx0, color, a);
+        }
+    }
+
+    // Raster sink (src/algorithms/raster.h): every pixel becomes a splat of
+    // `size`, so Bresenham / midpoint / Wu output gets width on screen
+    struct BrushSink {
+        CpuFramebuffer& fb;
+        float size;
+        bool smooth;
+        uint32_t color;
+        int alpha;
+        BlendMode mode;
+
+        void point(int x, int y) { fb.splat(x + 0.5f, y + 0.5f, size, smooth, color, alpha, mode); }
+        void coverage(int x, int y, int weight) {
+            fb.splat(x + 0.5f, y + 0.5f, size, smooth, color, (alpha * weight) / 255, mode);
+        }
+        void segment(int x0, int y0, int x1, int y1) {
+            int r = (int)std::ceil(size) + 1;   // brushes reach past the edge
+            raster::clippedLine(x0, y0, x1, y1,
+                                raster::ClipRect{-r, -r, fb.width - 1 + r, fb.height - 1 + r}, *this);
+        }
+    };
+
+    BrushSink brush(float size, bool smooth, uint32_t color, BlendMode mode = BLEND_ALPHA) {
+        return BrushSink{*this, size, smooth, color & 0x00FFFFFFu, (int)(color >> 24), mode};
+    }
+
+    // ----------------------
+    // Image output
+    // ----------------------
+    bool writePPM(const char* path) const {
+        FILE* f = std::fopen(path, "wb");
+        if (!f) return false;
+        std::fprintf(f, "P6\n%d %d\n255\n", width, height);
+        std::vector<uint8_t> rgb;
+        packRGB(rgb);
+        bool ok = std::fwrite(rgb.data(), 1, rgb.size(), f) == rgb.size();
+        return std::fclose(f) == 0 && ok;
+    }
+
+    // Binary (P6) 8-bit PPM, as written by writePPM; alpha becomes 255
+    bool readPPM(const char* path) {
+        FILE* f = std::fopen(path, "rb");
+        if (!f) return false;
+        int w = 0, h = 0, maxval = 0;
+        bool ok = std::fscanf(f, "P6 %d %d %d", &w, &h, &maxval) == 3 && maxval == 255 &&
+                  w > 0 && h > 0 && std::fgetc(f) != EOF;
+        std::vector<uint8_t> rgb;
+        if (ok) {
+            rgb.resize((size_t)w * h * 3);
+            ok = std::fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+        }
+        std::fclose(f);
+        if (!ok) return false;
+        resize(w, h);
+        for (size_t i = 0; i < pixels.size(); i++)
+            pixels[i] = packRGBA(rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2], 255);
+        return true;
+    }
+
+    // 8-bit RGB PNG, stored deflate blocks
+    bool writePNG(const char* path) const {
+        // Scanlines with filter byte 0, wrapped in a zlib stream of stored blocks
+        std::vector<uint8_t> raw;
+        raw.reserve((size_t)height * (width * 3 + 1));
+        std::vector<uint8_t> rgb;
+        packRGB(rgb);
+        for (int y = 0; y < height; y++) {
+            raw.push_back(0);
+            raw.insert(raw.end(), rgb.begin() + (size_t)y * width * 3,
+                       rgb.begin() + (size_t)(y + 1) * width * 3);
+        }
+        std::vector<uint8_t> z;
+        z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+        z.push_back(0x78);
+        z.push_back(0x01);
+        for (size_t at = 0; at < raw.size() || at == 0; ) {
+            size_t n = std::min<size_t>(65535, raw.size() - at);
+            bool last = at + n == raw.size();
+            z.push_back(last ? 1 : 0);
+            z.push_back((uint8_t)(n & 0xFF));
+            z.push_back((uint8_t)(n >> 8));
+            z.push_back((uint8_t)(~n & 0xFF));
+            z.push_back((uint8_t)((~n >> 8) & 0xFF));
+            z.insert(z.end(), raw.begin() + at, raw.begin() + at + n);
+            at += n;
+            if (last) break;
+        }
+        putBE32(z, adler32(raw.data(), raw.size()));
+
+        FILE* f = std::fopen(path, "wb");
+        if (!f) return false;
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        bool ok = std::fwrite(signature, 1, 8, f) == 8;
+        std::vector<uint8_t> ihdr;
+        putBE32(ihdr, (uint32_t)width);
+        putBE32(ihdr, (uint32_t)height);
+        const uint8_t format[5] = {8, 2, 0, 0, 0};   // 8-bit, RGB, deflate, no filter, no interlace
+        ihdr.insert(ihdr.end(), format, format + 5);
+        ok = ok && writeChunk(f, "IHDR", ihdr) && writeChunk(f, "IDAT", z) &&
+             writeChunk(f, "IEND", std::vector<uint8_t>());
+        return std::fclose(f) == 0 && ok;
+    }
+
+private:
+    struct Splat {
+        int side = 0;
+        std::vector<uint8_t> mask;
+    };
+
+    // Masks are cached per quarter pixel of size
+    const Splat& splatFor(float size, bool smooth) {
+        int quarters = std::max(1, (int)std::lround(size * 4.0f));
+        int key = quarters * 2 + (smooth ? 1 : 0);
+        std::unordered_map<int, Splat>::iterator it = splats.find(key);
+        if (it != splats.end()) return it->second;
+
+        Splat& s = splats[key];
+        float d = quarters / 4.0f;
+        if (!smooth) {
+            // GL point: a d x d square
+            s.side = std::max(1, (int)std::lround(d));
+            s.mask.assign((size_t)s.side * s.side, 255);
+        } else {
+            // GL_POINT_SMOOTH: a disc of diameter d with a one-pixel soft edge
+            s.side = (int)std::ceil(d) + 1;
+            s.mask.resize((size_t)s.side * s.side);
+            float c = s.side * 0.5f, r = d * 0.5f;
+            for (int y = 0; y < s.side; y++)
+                for (int x = 0; x < s.side; x++) {
+                    float dx = x + 0.5f - c, dy = y + 0.5f - c;
+                    float cover = std::min(1.0f, std::max(0.0f, r + 0.5f - std::sqrt(dx * dx + dy * dy)));
+                    s.mask[(size_t)y * s.side + x] = (uint8_t)(cover * 255.0f + 0.5f);
+                }
+        }
+        return s;
+    }
+
+    void packRGB(std::vector<uint8_t>& rgb) const {
+        rgb.resize(pixels.size() * 3);
+        for (size_t i = 0; i < pixels.size(); i++) {
+            uint32_t p = pixels[i];
+            rgb[3 * i] = (uint8_t)p;
+            rgb[3 * i + 1] = (uint8_t)(p >> 8);
+            rgb[3 * i + 2] = (uint8_t)(p >> 16);
+        }
+    }
+
+    static void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+        out.push_back((uint8_t)(v >> 24));
+        out.push_back((uint8_t)(v >> 16));
+        out.push_back((uint8_t)(v >> 8));
+        out.push_back((uint8_t)v);
+    }
+
+    static uint32_t adler32(const uint8_t* data, size_t n) {
+        uint32_t a = 1, b = 0;
+        while (n > 0) {
+            size_t block = std::min<size_t>(n, 5552);   // largest run without overflow
+            n -= block;
+            while (block--) {
+                a += *data++;
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t n) {
+        static uint32_t table[256];
+        static bool ready = false;
+        if (!ready) {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[i] = c;
+            }
+            ready = true;
+        }
+        crc = ~crc;
+        for (size_t i = 0; i < n; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    static bool writeChunk(FILE* f, const char* type, const std::vector<uint8_t>& body) {
+        std::vector<uint8_t> head;
+        putBE32(head, (uint32_t)body.size());
+        head.insert(head.end(), type, type + 4);
+        uint32_t crc = crc32(0, (const uint8_t*)type, 4);
+        crc = crc32(crc, body.data(), body.size());
+        std::vector<uint8_t> tail;
+        putBE32(tail, crc);
+        return std::fwrite(head.data(), 1, head.size(), f) == head.size() &&
+               std::fwrite(body.data(), 1, body.size(), f) == body.size() &&
+               std::fwrite(tail.data(), 1, tail.size(), f) == tail.size();
+    }
+
+    int width = 0, height = 0;
+    std::vector<uint32_t> pixels;
+    std::unordered_map<int, Splat> splats;
+};
+
+// ----------------------
+// Golden-image comparison
+// ----------------------
+// Per-channel RGB differences. GL implementations differ by a few levels
+// along edges and in rounding, so callers compare the mean against a
+// tolerance instead of asking for exact equality.
+struct ImageDiff {
+    bool sameSize = false;
+    double meanError = 0;     // mean absolute difference per channel, 0..255
+    int maxError = 0;
+    double badPixels = 0;     // fraction with any channel off by more than 16
+    double psnr = 0;          // dB, infinite when identical
+};
+
+inline ImageDiff compareImages(const CpuFramebuffer& a, const CpuFramebuffer& b) {
+    ImageDiff d;
+    d.sameSize = a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight();
+    if (!d.sameSize) return d;
+    size_t n = (size_t)a.getWidth() * a.getHeight(), bad = 0;
+    double sum = 0, squares = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t pa = a.data()[i], pb = b.data()[i];
+        int worst = 0;
+        for (int c = 0; c < 24; c += 8) {
+            int e = std::abs((int)((pa >> c) & 0xFF) - (int)((pb >> c) & 0xFF));
+            sum += e;
+            squares += (double)e * e;
+            worst = std::max(worst, e);
+        }
+        d.maxError = std::max(d.maxError, worst);
+        if (worst > 16) bad++;
+    }
+    d.meanError = sum / (3.0 * n);
+    d.badPixels = (double)bad / n;
+    double mse = squares / (3.0 * n);
+    d.psnr = mse > 0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+    return d;
+}
+
+#endif
@@ -0,0 +1,171 @@
+// ======================
+// CPU Overlay Renderer
+// ======================
+// Draws the draw2D() overlay (grid, constellations, orbits, planets, stars)
+// into a CpuFramebuffer with no GL context, for render nodes without a GPU.
+// draw2D() submits exactly what it would give the render queue; items are
+// sorted by the same 64-bit key, so the layering matches the GL path.
+//
+// Vertices go through the view-projection matrix and viewport here. Points
+// become splats of the key's point size (round unless RS_NO_SMOOTH).
+// Lines are clipped to the near plane in clip space, then drawn with
+// raster::clippedLine through a round brush of the key's line width, which
+// comes close to GL_LINE_SMOOTH. RS_ADDITIVE selects additive blending and
+// everything else alpha-blends, like GLStateCache. GL point sizes and line
+// widths are in window pixels, so `pixelScale` stretches them to the output
+// resolution.
+
+#ifndef COSMIC_CPU_OVERLAY_H
+#define COSMIC_CPU_OVERLAY_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "cpu_framebuffer.h"
+#include "frustum.h"
+#include "render_queue.h"
+#include "scene_cache.h"
+
+struct CpuOverlayStats {
+    int items = 0;
+    size_t points = 0;      // splats drawn
+    size_t lines = 0;       // segments drawn
+    size_t culled = 0;      // vertices / segments behind the near plane
+};
+
+class CpuOverlay {
+public:
+    explicit CpuOverlay(CpuFramebuffer& fb) : fb(fb) {}
+
+    float pixelScale = 1.0f;
+
+    void setViewProjection(const float m[16]) { std::copy(m, m + 16, matrix); }
+
+    // One layer (or some of its ranges); the vertices must stay valid until flush()
+    void submit(uint64_t key, const SceneLayer& layer, const GLint* firsts = nullptr,
+                const GLsizei* counts = nullptr, int ranges = 0) {
+        const SceneVertex* v = layer.clientVertices();
+        if (!v) return;
+        Item item;
+        item.key = key;
+        item.lines = layer.primitiveType() == GL_LINES;
+        item.vertices = v;
+        item.first = (uint32_t)rangeFirsts.size();
+        if (!firsts) {
+            rangeFirsts.push_back(0);
+            rangeCounts.push_back((GLsizei)layer.vertexCount());
+        } else {
+            rangeFirsts.insert(rangeFirsts.end(), firsts, firsts + ranges);
+            rangeCounts.insert(rangeCounts.end(), counts, counts + ranges);
+        }
+        item.end = (uint32_t)rangeFirsts.size();
+        items.push_back(item);
+    }
+
+    // Draw everything submitted since the last flush, in sort-key order
+    void flush() {
+        frameStats = CpuOverlayStats();
+        frameStats.items = (int)items.size();
+        std::stable_sort(items.begin(), items.end(),
+                         [](const Item& a, const Item& b) { return a.key < b.key; });
+        for (const Item& item : items) {
+            unsigned state = sortKeyState(item.key);
+            float size = std::max(1.0f, sortKeySize(item.key) * pixelScale);
+            CpuFramebuffer::BlendMode mode =
+                (state & RS_ADDITIVE) ? CpuFramebuffer::BLEND_ADD : CpuFramebuffer::BLEND_ALPHA;
+            bool smooth = !(state & RS_NO_SMOOTH);
+            for (uint32_t r = item.first; r < item.end; r++) {
+                const SceneVertex* v = item.vertices + rangeFirsts[r];
+                if (item.lines) drawLines(v, rangeCounts[r], size, mode);
+                else drawPoints(v, rangeCounts[r], size, smooth, mode);
+            }
+        }
+        items.clear();
+        rangeFirsts.clear();
+        rangeCounts.clear();
+    }
+
+    const CpuOverlayStats& stats() const { return frameStats; }
+
+private:
+    struct Item {
+        uint64_t key;
+        bool lines;
+        const SceneVertex* vertices;
+        uint32_t first, end;   // into rangeFirsts / rangeCounts
+    };
+
+    struct Clip {
+        float x, y, z, w;
+    };
+
+    Clip toClip(const SceneVertex& v) const {
+        const float* m = matrix;
+        return Clip{m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12],
+                    m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13],
+                    m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14],
+                    m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15]};
+    }
+
+    // Clip space to framebuffer pixels (y down), clamped so far-off-screen
+    // line ends stay within int range for the clipper
+    void toScreen(const Clip& c, float& sx, float& sy) const {
+        float inv = 1.0f / c.w;
+        sx = (c.x * inv * 0.5f + 0.5f) * fb.getWidth();
+        sy = (0.5f - c.y * inv * 0.5f) * fb.getHeight();
+        const float lim = 1 << 24;
+        sx = std::min(std::max(sx, -lim), lim);
+        sy = std::min(std::max(sy, -lim), lim);
+    }
+
+    static uint32_t colorOf(const SceneVertex& v) { return packRGBA(v.r, v.g, v.b, v.a); }
+
+    void drawPoints(const SceneVertex* v, GLsizei count, float size, bool smooth,
+                    CpuFramebuffer::BlendMode mode) {
+        for (GLsizei i = 0; i < count; i++) {
+            Clip c = toClip(v[i]);
+            if (c.z < -c.w || c.z > c.w) {   // outside near / far, as GL drops whole points
+                frameStats.culled++;
+                continue;
+            }
+            float sx, sy;
+            toScreen(c, sx, sy);
+            fb.splat(sx, sy, size, smooth, packRGBA(v[i].r, v[i].g, v[i].b, 0), v[i].a, mode);
+            frameStats.points++;
+        }
+    }
+
+    void drawLines(const SceneVertex* v, GLsizei count, float width, CpuFramebuffer::BlendMode mode) {
+        for (GLsizei i = 0; i + 1 < count; i += 2) {
+            Clip a = toClip(v[i]), b = toClip(v[i + 1]);
+            // Near plane z >= -w
+            float da = a.z + a.w, db = b.z + b.w;
+            if (da < 0 && db < 0) {
+                frameStats.culled++;
+                continue;
+            }
+            if (da < 0 || db < 0) {
+                float t = da / (da - db);
+                Clip p{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t,
+                       a.w + (b.w - a.w) * t};
+                (da < 0 ? a : b) = p;
+            }
+            float x0, y0, x1, y1;
+            toScreen(a, x0, y0);
+            toScreen(b, x1, y1);
+            CpuFramebuffer::BrushSink brush = fb.brush(width, true, colorOf(v[i]), mode);
+            brush.segment((int)std::floor(x0), (int)std::floor(y0), (int)std::floor(x1), (int)std::floor(y1));
+            frameStats.lines++;
+        }
+    }
+
+    CpuFramebuffer& fb;
+    float matrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    std::vector<Item> items;
+    std::vector<GLint> rangeFirsts;
+    std::vector<GLsizei> rangeCounts;
+    CpuOverlayStats frameStats;
+};
+
+#endif
@@ -0,0 +1,195 @@
+// ======================
+// Frame Damage Tracking
+// ======================
+// Event-driven rendering for installations that run around the clock:
+//   - FrameDamage collects why the next frame is needed (camera moved,
+//     setting changed, animation running, window changed) or, when only
+//     some overlay layers changed, the window rectangle they cover. No
+//     damage means no redraw at all.
+//   - RetainedFrame keeps the last frame in a framebuffer object, so a
+//     frame with partial damage redraws just the scissored rectangle and
+//     an expose only re-presents the stored image.
+// Rectangles are in GL window coordinates (origin bottom-left), half-open.
+
+#ifndef COSMIC_FRAME_DAMAGE_H
+#define COSMIC_FRAME_DAMAGE_H
+
+#include <algorithm>
+#include "gl_ext.h"
+#include "transform.h"
+
+struct ScreenRect {
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+    long long area() const { return empty() ? 0 : (long long)(x1 - x0) * (y1 - y0); }
+
+    void unite(const ScreenRect& o) {
+        if (o.empty()) return;
+        if (empty()) {
+            *this = o;
+            return;
+        }
+        x0 = std::min(x0, o.x0); y0 = std::min(y0, o.y0);
+        x1 = std::max(x1, o.x1); y1 = std::max(y1, o.y1);
+    }
+
+    ScreenRect clipped(int width, int height) const {
+        ScreenRect r;
+        r.x0 = std::max(x0, 0); r.y0 = std::max(y0, 0);
+        r.x1 = std::min(x1, width); r.y1 = std::min(y1, height);
+        return r;
+    }
+};
+
+// Window rectangle covering a world-space box, grown by `pad` pixels for
+// point sizes and line widths. Conservative: a box reaching behind the eye
+// plane covers the whole window.
+inline ScreenRect projectBox(const Mat4& viewProjection, const float lo[3], const float hi[3],
+                             int width, int height, int pad) {
+    ScreenRect full;
+    full.x1 = width;
+    full.y1 = height;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    for (int corner = 0; corner < 8; corner++) {
+        Vec4 c = viewProjection * Vec4{(corner & 1) ? hi[0] : lo[0], (corner & 2) ? hi[1] : lo[1],
+                                       (corner & 4) ? hi[2] : lo[2], 1.0f};
+        if (c.w <= 1e-4f) return full;
+        float x = (c.x / c.w * 0.5f + 0.5f) * width, y = (c.y / c.w * 0.5f + 0.5f) * height;
+        minX = std::min(minX, x); maxX = std::max(maxX, x);
+        minY = std::min(minY, y); maxY = std::max(maxY, y);
+    }
+    ScreenRect r;
+    r.x0 = (int)std::max(-1e6f, std::floor(minX)) - pad;
+    r.y0 = (int)std::max(-1e6f, std::floor(minY)) - pad;
+    r.x1 = (int)std::min(1e6f, std::ceil(maxX)) + pad + 1;
+    r.y1 = (int)std::min(1e6f, std::ceil(maxY)) + pad + 1;
+    return r.clipped(width, height);
+}
+
+enum DamageReason {
+    DAMAGE_CAMERA = 1,      // view or projection changed
+    DAMAGE_SETTINGS = 2,    // a change that touches the whole frame
+    DAMAGE_ANIMATION = 4,   // twinkle, star LOD fade
+    DAMAGE_WINDOW = 8,      // resize, first frame
+    DAMAGE_OVERLAY = 16     // only the rectangle in region()
+};
+
+struct DamageStats {
+    long long framesDrawn = 0;      // full redraws
+    long long partialFrames = 0;    // scissored redraws
+    long long presentedOnly = 0;    // re-presented without drawing
+    long long framesSkipped = 0;    // frame ticks that needed nothing
+    double pixelsSaved = 0;         // window pixels not redrawn by partial / present-only frames
+    double pixelsTotal = 0;         // window pixels of every frame shown
+};
+
+class FrameDamage {
+public:
+    FrameDamage() { invalidate(DAMAGE_WINDOW); }
+
+    void invalidate(unsigned reason) {
+        reasons |= reason;
+        full = true;
+    }
+    void damage(const ScreenRect& r) {
+        reasons |= DAMAGE_OVERLAY;
+        rect.unite(r);
+    }
+
+    bool dirty() const { return reasons != 0; }
+    bool partial() const { return reasons != 0 && !full; }
+    unsigned pending() const { return reasons; }
+    const ScreenRect& region() const { return rect; }
+
+    // Bookkeeping once the frame is on screen; clears the damage
+    void frameShown(int width, int height, bool drawnPartially, bool presentOnly) {
+        double area = (double)width * height;
+        stats.pixelsTotal += area;
+        if (presentOnly) {
+            stats.presentedOnly++;
+            stats.pixelsSaved += area;
+        } else if (drawnPartially) {
+            stats.partialFrames++;
+            stats.pixelsSaved += area - (double)rect.clipped(width, height).area();
+        } else {
+            stats.framesDrawn++;
+        }
+        reasons = 0;
+        full = false;
+        rect = ScreenRect();
+    }
+    void frameSkipped() { stats.framesSkipped++; }
+
+    const DamageStats& counters() const { return stats; }
+
+private:
+    unsigned reasons = 0;
+    bool full = false;
+    ScreenRect rect;
+    DamageStats stats;
+};
+
+// ----------------------
+// Last frame, kept for partial redraws
+// ----------------------
+class RetainedFrame {
+public:
+    ~RetainedFrame() { release(); }
+
+    // (Re)allocate colour + depth at the window size; false without FBOs or
+    // on a multisampled window, which a blit cannot copy into
+    bool resize(int w, int h) {
+        release();
+        if (!glext::hasFramebuffers || w <= 0 || h <= 0) return false;
+        GLint sampleBuffers = 0;
+        glGetIntegerv(GL_SAMPLE_BUFFERS, &sampleBuffers);
+        if (sampleBuffers > 0) return false;
+        glext::GenFramebuffers(1, &fbo);
+        glext::GenRenderbuffers(2, buffers);
+        glext::BindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glext::BindRenderbuffer(GL_RENDERBUFFER, buffers[0]);
+        glext::RenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+        glext::FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, buffers[0]);
+        glext::BindRenderbuffer(GL_RENDERBUFFER, buffers[1]);
+        glext::RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+        glext::FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, buffers[1]);
+        glext::BindRenderbuffer(GL_RENDERBUFFER, 0);
+        bool complete = glext::CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glext::BindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete) {
+            release();
+            return false;
+        }
+        width = w;
+        height = h;
+        return true;
+    }
+
+    bool ready() const { return fbo != 0; }
+
+    void bind() const { glext::BindFramebuffer(GL_FRAMEBUFFER, fbo); }
+
+    // Copy to the window's back buffer and leave the window bound
+    void present() const {
+        glext::BindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glext::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glext::BlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glext::BindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void release() {
+        if (fbo && glext::hasFramebuffers) {
+            glext::DeleteFramebuffers(1, &fbo);
+            glext::DeleteRenderbuffers(2, buffers);
+        }
+        fbo = 0;
+        buffers[0] = buffers[1] = 0;
+    }
+
+private:
+    GLuint fbo = 0, buffers[2] = {0, 0};
+    int width = 0, height = 0;
+};
+
+#endif
@@ -0,0 +1,265 @@
+// ======================
+// Frame Profiler
+// ======================
+// Where each frame's time goes, cheap enough to leave on all the time:
+//   - CPU time per stage from steady_clock, summed over the stage's scopes
+//     (queueing in drawSky() / draw2D() / drawTelescope() plus issuing its
+//     render queue pass),
+//   - GPU time per pass from GL_TIME_ELAPSED queries. Each frame uses the
+//     next query set of a small ring and results are only read once GL
+//     reports them available, a few frames later, so the CPU never waits,
+//   - the last kHistory frames, from which percentiles() gives p50/p95/p99
+//     and writeCsv() / writeJson() dump the samples and the summary.
+// The cost is two clock reads per scope and three queries per frame. While
+// the trace recorder runs, every timed scope also becomes a trace span.
+
+#ifndef COSMIC_FRAME_PROFILER_H
+#define COSMIC_FRAME_PROFILER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "gl_ext.h"
+#include "trace_recorder.h"
+
+enum ProfileStage {
+    STAGE_SKY,         // catalog sky (render pass PASS_SKY)
+    STAGE_OVERLAY,     // draw2D() (PASS_OVERLAY)
+    STAGE_TELESCOPE,   // drawTelescope() (PASS_OPAQUE)
+    STAGE_SWAP,        // glutSwapBuffers(), CPU only
+    STAGE_FRAME,       // all of display(), CPU only
+    STAGE_COUNT
+};
+const int kGpuStages = STAGE_SWAP;   // the stages that are render passes
+
+inline const char* profileStageName(int stage) {
+    static const char* const names[STAGE_COUNT] = {"sky", "overlay", "telescope", "swap", "frame"};
+    return stage >= 0 && stage < STAGE_COUNT ? names[stage] : "?";
+}
+
+struct StagePercentiles {
+    float p50 = 0, p95 = 0, p99 = 0;
+    int samples = 0;
+};
+
+class FrameProfiler {
+public:
+    static const int kHistory = 600;   // frames kept (10 s at 60 fps)
+    static const int kQueryRing = 4;   // frames of GPU queries in flight
+
+    FrameProfiler() {
+        std::fill(&frameOf[0], &frameOf[0] + kHistory, -1LL);
+        std::fill(&slotFrame[0], &slotFrame[0] + kQueryRing, -1LL);
+    }
+    ~FrameProfiler() { release(); }
+
+    // Once the GL context exists; without timer queries only CPU time is kept
+    void init() {
+        release();
+        gpu = glext::hasTimerQueries;
+        if (gpu) glext::GenQueries(kQueryRing * kGpuStages, &queries[0][0]);
+    }
+    void release() {
+        if (gpu && glext::hasTimerQueries) glext::DeleteQueries(kQueryRing * kGpuStages, &queries[0][0]);
+        gpu = false;
+    }
+    bool gpuTimers() const { return gpu; }
+
+    void beginFrame() {
+        frame++;
+        frameStart = Clock::now();
+        std::fill(cpuTotal, cpuTotal + STAGE_COUNT, 0.0f);
+        collect();
+        slot = (int)(frame % kQueryRing);
+        if (slotFrame[slot] >= 0) {   // still in flight after kQueryRing frames: give up on it
+            droppedFrames++;
+            slotFrame[slot] = -1;
+        }
+        std::fill(issued[slot], issued[slot] + kGpuStages, false);
+    }
+
+    void beginCpu(int stage) { cpuStart[stage] = Clock::now(); }
+    void endCpu(int stage) {
+        Clock::time_point now = Clock::now();
+        cpuTotal[stage] += std::chrono::duration<float, std::milli>(now - cpuStart[stage]).count();
+        traceRecorder().complete(profileStageName(stage), "frame", cpuStart[stage], now);
+    }
+
+    // GL_TIME_ELAPSED queries cannot nest, so one GPU stage at a time;
+    // beginning the next ends the previous
+    void beginGpu(int stage) {
+        if (!gpu) return;
+        endGpu();
+        glext::BeginQuery(GL_TIME_ELAPSED, queries[slot][stage]);
+        issued[slot][stage] = true;
+        gpuActive = true;
+    }
+    void endGpu() {
+        if (!gpuActive) return;
+        glext::EndQuery(GL_TIME_ELAPSED);
+        gpuActive = false;
+    }
+
+    void endFrame() {
+        endGpu();
+        Clock::time_point now = Clock::now();
+        cpuTotal[STAGE_FRAME] = std::chrono::duration<float, std::milli>(now - frameStart).count();
+        traceRecorder().complete(profileStageName(STAGE_FRAME), "frame", frameStart, now);
+        int row = (int)(frame % kHistory);
+        frameOf[row] = frame;
+        std::copy(cpuTotal, cpuTotal + STAGE_COUNT, cpuMs[row]);
+        std::fill(gpuMs[row], gpuMs[row] + kGpuStages, -1.0f);
+        if (gpu) slotFrame[slot] = frame;
+    }
+
+    long long frames() const { return frame; }
+    long long droppedGpuFrames() const { return droppedFrames; }
+    // GPU time of the newest frame whose queries have come back; < 0 if none yet
+    float latestGpuFrameMs() const { return latestGpuMs; }
+
+    StagePercentiles percentiles(int stage, bool gpuTime) const {
+        std::vector<float>& v = scratch;
+        v.clear();
+        for (int row = 0; row < kHistory; row++) {
+            if (frameOf[row] < 0) continue;
+            float ms = sample(row, stage, gpuTime);
+            if (ms >= 0.0f) v.push_back(ms);
+        }
+        StagePercentiles p;
+        p.samples = (int)v.size();
+        if (v.empty()) return p;
+        std::sort(v.begin(), v.end());
+        p.p50 = rank(v, 0.50f);
+        p.p95 = rank(v, 0.95f);
+        p.p99 = rank(v, 0.99f);
+        return p;
+    }
+
+    // One row per kept frame, oldest first; GPU cells are empty until read back
+    bool writeCsv(const char* path) const {
+        FILE* f = std::fopen(path, "w");
+        if (!f) return false;
+        std::fprintf(f, "frame");
+        for (int s = 0; s < STAGE_COUNT; s++) std::fprintf(f, ",cpu_%s_ms", profileStageName(s));
+        for (int s = 0; s < kGpuStages; s++) std::fprintf(f, ",gpu_%s_ms", profileStageName(s));
+        std::fprintf(f, "\n");
+        for (long long n = std::max(1LL, frame - kHistory + 1); n <= frame; n++) {
+            int row = (int)(n % kHistory);
+            if (frameOf[row] != n) continue;
+            std::fprintf(f, "%lld", n);
+            for (int s = 0; s < STAGE_COUNT; s++) std::fprintf(f, ",%.4f", cpuMs[row][s]);
+            for (int s = 0; s < kGpuStages; s++) {
+                if (gpuMs[row][s] >= 0.0f) std::fprintf(f, ",%.4f", gpuMs[row][s]);
+                else std::fprintf(f, ",");
+            }
+            std::fprintf(f, "\n");
+        }
+        return std::fclose(f) == 0;
+    }
+
+    // Percentiles per stage over the kept frames
+    bool writeJson(const char* path) const {
+        FILE* f = std::fopen(path, "w");
+        if (!f) return false;
+        std::fprintf(f, "{\n  \"frames\": %lld,\n  \"window\": %d,\n  \"gpuTimers\": %s,\n"
+                        "  \"droppedGpuFrames\": %lld,\n  \"stages\": {\n",
+                     frame, (int)std::min<long long>(frame, kHistory), gpu ? "true" : "false", droppedFrames);
+        for (int s = 0; s < STAGE_COUNT; s++) {
+            std::fprintf(f, "    \"%s\": {", profileStageName(s));
+            writeJsonPercentiles(f, "cpu", percentiles(s, false));
+            if (s < kGpuStages && gpu) {
+                std::fprintf(f, ", ");
+                writeJsonPercentiles(f, "gpu", percentiles(s, true));
+            }
+            std::fprintf(f, "}%s\n", s + 1 < STAGE_COUNT ? "," : "");
+        }
+        std::fprintf(f, "  }\n}\n");
+        return std::fclose(f) == 0;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // Read finished query sets, oldest first; stop at the first one still
+    // running (they finish in order)
+    void collect() {
+        for (int i = 0; i < kQueryRing; i++) {
+            int s = (int)((frame + i) % kQueryRing);
+            long long n = slotFrame[s];
+            if (n < 0) continue;
+            float ms[kGpuStages];
+            float total = 0.0f;
+            bool ready = true;
+            for (int stage = 0; stage < kGpuStages && ready; stage++) {
+                ms[stage] = 0.0f;   // a pass with nothing queued cost nothing
+                if (!issued[s][stage]) continue;
+                GLint available = 0;
+                glext::GetQueryObjectiv(queries[s][stage], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) {
+                    ready = false;
+                    break;
+                }
+                GLuint64 ns = 0;
+                glext::GetQueryObjectui64v(queries[s][stage], GL_QUERY_RESULT, &ns);
+                ms[stage] = (float)(ns / 1.0e6);
+                total += ms[stage];
+            }
+            if (!ready) break;
+            slotFrame[s] = -1;
+            latestGpuMs = total;
+            int row = (int)(n % kHistory);
+            if (frameOf[row] == n) std::copy(ms, ms + kGpuStages, gpuMs[row]);
+        }
+    }
+
+    float sample(int row, int stage, bool gpuTime) const {
+        if (!gpuTime) return cpuMs[row][stage];
+        return stage < kGpuStages ? gpuMs[row][stage] : -1.0f;
+    }
+
+    // Nearest-rank percentile of sorted samples
+    static float rank(const std::vector<float>& sorted, float p) {
+        size_t i = (size_t)std::ceil(p * sorted.size());
+        return sorted[std::min(sorted.size(), std::max<size_t>(i, 1)) - 1];
+    }
+
+    static void writeJsonPercentiles(FILE* f, const char* name, const StagePercentiles& p) {
+        std::fprintf(f, "\"%s\": {\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"samples\": %d}", name, p.p50,
+                     p.p95, p.p99, p.samples);
+    }
+
+    long long frame = 0;
+    Clock::time_point frameStart, cpuStart[STAGE_COUNT];
+    float cpuTotal[STAGE_COUNT] = {};
+
+    long long frameOf[kHistory];   // which frame each history row holds (-1 = none)
+    float cpuMs[kHistory][STAGE_COUNT];
+    float gpuMs[kHistory][kGpuStages];   // -1 until read back
+
+    bool gpu = false, gpuActive = false;
+    int slot = 0;
+    GLuint queries[kQueryRing][kGpuStages] = {};
+    bool issued[kQueryRing][kGpuStages] = {};
+    long long slotFrame[kQueryRing];   // frame whose queries a slot holds (-1 = free)
+    long long droppedFrames = 0;
+    float latestGpuMs = -1.0f;
+
+    mutable std::vector<float> scratch;
+};
+
+// Times one CPU stage for the rest of the enclosing block
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& profiler, int stage) : profiler(profiler), stage(stage) {
+        profiler.beginCpu(stage);
+    }
+    ~ProfileScope() { profiler.endCpu(stage); }
+
+private:
+    FrameProfiler& profiler;
+    int stage;
+};
+
+#endif
@@ -0,0 +1,61 @@
+// ======================
+// View Frustum
+// ======================
+// Six inward-facing planes extracted from a combined projection * modelview
+// matrix (Gribb & Hartmann), plus the sphere test the culling code needs.
+// Matrices are column-major, as glGetFloatv returns them.
+
+#ifndef COSMIC_FRUSTUM_H
+#define COSMIC_FRUSTUM_H
+
+#include <cmath>
+
+// out = a * b, all column-major 4x4
+inline void multiplyMatrices(const float a[16], const float b[16], float out[16]) {
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            out[c * 4 + r] = a[0 * 4 + r] * b[c * 4 + 0] + a[1 * 4 + r] * b[c * 4 + 1] +
+                             a[2 * 4 + r] * b[c * 4 + 2] + a[3 * 4 + r] * b[c * 4 + 3];
+}
+
+enum FrustumTest { FRUSTUM_OUTSIDE = -1, FRUSTUM_INTERSECTS = 0, FRUSTUM_INSIDE = 1 };
+
+struct Frustum {
+    // left, right, bottom, top, near, far; (a, b, c, d) with unit (a, b, c)
+    float planes[6][4];
+
+    void fromMatrix(const float m[16]) {
+        for (int i = 0; i < 3; i++) {
+            for (int k = 0; k < 4; k++) {
+                float row3 = m[k * 4 + 3];
+                float rowI = m[k * 4 + i];
+                planes[i * 2 + 0][k] = row3 + rowI;
+                planes[i * 2 + 1][k] = row3 - rowI;
+            }
+        }
+        for (int p = 0; p < 6; p++) {
+            float len = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] +
+                                  planes[p][2] * planes[p][2]);
+            if (len > 0.0f)
+                for (int k = 0; k < 4; k++) planes[p][k] /= len;
+        }
+    }
+
+    void fromMatrices(const float projection[16], const float modelview[16]) {
+        float m[16];
+        multiplyMatrices(projection, modelview, m);
+        fromMatrix(m);
+    }
+
+    FrustumTest testSphere(float x, float y, float z, float radius) const {
+        FrustumTest result = FRUSTUM_INSIDE;
+        for (int p = 0; p < 6; p++) {
+            float d = planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3];
+            if (d < -radius) return FRUSTUM_OUTSIDE;
+            if (d < radius) result = FRUSTUM_INTERSECTS;
+        }
+        return result;
+    }
+};
+
+#endif
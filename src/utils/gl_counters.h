@@ -0,0 +1,143 @@
+// ======================
+// GL Call Counters
+// ======================
+// Per-frame counts of GL calls, glBegin/glEnd pairs, vertices, material
+// calls and state changes, attributed to the subsystem that submitted them.
+// Only built with -DCOSMIC_GL_COUNTERS (debug / profile builds):
+//   - the GL 1.1 entry points the renderer uses become macros that count,
+//     then make the real call,
+//   - loadGLExtensions() swaps the per-frame extension entry points
+//     (glMultiDrawArrays, buffer binds, program and uniform calls) for
+//     counting thunks,
+//   - the render queue tags each draw item with its subsystem and switches
+//     the current subsystem before applying the item's state.
+// Without the flag every function here is an empty inline.
+//
+// Include after the GL headers and before any code that calls GL.
+
+#ifndef COSMIC_GL_COUNTERS_H
+#define COSMIC_GL_COUNTERS_H
+
+#include <GL/glut.h>
+
+enum GLSubsystem {
+    GLSUB_OTHER,            // clears, camera matrices, anything untagged
+    GLSUB_GRID,             // floor grid + centre cross
+    GLSUB_CONSTELLATIONS,   // figures on the floor and the sky, chart stars
+    GLSUB_ORBITS,
+    GLSUB_PLANETS,          // sun + planets
+    GLSUB_STARS,            // floor star field, deep-sky points, catalog sky
+    GLSUB_TELESCOPE,
+    GLSUB_COUNT
+};
+
+inline const char* glSubsystemName(int subsystem) {
+    static const char* const names[GLSUB_COUNT] = {"other",   "grid",  "constellations", "orbits",
+                                                   "planets", "stars", "telescope"};
+    return subsystem >= 0 && subsystem < GLSUB_COUNT ? names[subsystem] : "?";
+}
+
+struct GLCallCounts {
+    long calls = 0;          // every counted entry point
+    long beginEnd = 0;       // glBegin/glEnd pairs
+    long vertices = 0;       // glVertex* calls plus vertices drawn from arrays
+    long drawCalls = 0;      // glBegin, glDrawArrays, glMultiDrawArrays, glDrawPixels
+    long materials = 0;      // glMaterial*
+    long stateChanges = 0;   // caps, blend, sizes, matrices, pointers, binds, uniforms
+
+    void add(const GLCallCounts& o) {
+        calls += o.calls;
+        beginEnd += o.beginEnd;
+        vertices += o.vertices;
+        drawCalls += o.drawCalls;
+        materials += o.materials;
+        stateChanges += o.stateChanges;
+    }
+};
+
+#ifdef COSMIC_GL_COUNTERS
+
+namespace glcount {
+
+struct Frame {
+    GLCallCounts subsystems[GLSUB_COUNT];
+};
+
+inline Frame& current() { static Frame f; return f; }
+inline Frame& last() { static Frame f; return f; }
+inline int& subsystem() { static int s = GLSUB_OTHER; return s; }
+inline GLCallCounts& counts() { return current().subsystems[subsystem()]; }
+
+inline void call() { counts().calls++; }
+inline void state() { GLCallCounts& c = counts(); c.calls++; c.stateChanges++; }
+inline void material() { GLCallCounts& c = counts(); c.calls++; c.materials++; }
+inline void vertex() { GLCallCounts& c = counts(); c.calls++; c.vertices++; }
+inline void begin() { GLCallCounts& c = counts(); c.calls++; c.beginEnd++; c.drawCalls++; }
+inline void draw(long vertices) { GLCallCounts& c = counts(); c.calls++; c.drawCalls++; c.vertices += vertices; }
+
+} // namespace glcount
+
+inline bool glCountersBuilt() { return true; }
+inline void glCounterSubsystem(unsigned subsystem) {
+    glcount::subsystem() = subsystem < GLSUB_COUNT ? (int)subsystem : GLSUB_OTHER;
+}
+// Call once the frame is on screen
+inline void glCountersEndFrame() {
+    glcount::last() = glcount::current();
+    glcount::current() = glcount::Frame();
+    glcount::subsystem() = GLSUB_OTHER;
+}
+inline GLCallCounts glCountersLastFrame(int subsystem) { return glcount::last().subsystems[subsystem]; }
+
+// ----------------------
+// Counted GL 1.1 entry points
+// ----------------------
+#define glBegin(...) (glcount::begin(), glBegin(__VA_ARGS__))
+#define glEnd(...) (glcount::call(), glEnd(__VA_ARGS__))
+
+#define glVertex2f(...) (glcount::vertex(), glVertex2f(__VA_ARGS__))
+#define glVertex2i(...) (glcount::vertex(), glVertex2i(__VA_ARGS__))
+#define glVertex3f(...) (glcount::vertex(), glVertex3f(__VA_ARGS__))
+#define glVertex3fv(...) (glcount::vertex(), glVertex3fv(__VA_ARGS__))
+#define glNormal3f(...) (glcount::call(), glNormal3f(__VA_ARGS__))
+#define glColor3f(...) (glcount::call(), glColor3f(__VA_ARGS__))
+#define glColor4f(...) (glcount::call(), glColor4f(__VA_ARGS__))
+
+#define glMaterialf(...) (glcount::material(), glMaterialf(__VA_ARGS__))
+#define glMaterialfv(...) (glcount::material(), glMaterialfv(__VA_ARGS__))
+
+#define glEnable(...) (glcount::state(), glEnable(__VA_ARGS__))
+#define glDisable(...) (glcount::state(), glDisable(__VA_ARGS__))
+#define glBlendFunc(...) (glcount::state(), glBlendFunc(__VA_ARGS__))
+#define glPointSize(...) (glcount::state(), glPointSize(__VA_ARGS__))
+#define glLineWidth(...) (glcount::state(), glLineWidth(__VA_ARGS__))
+#define glColorMaterial(...) (glcount::state(), glColorMaterial(__VA_ARGS__))
+#define glMatrixMode(...) (glcount::state(), glMatrixMode(__VA_ARGS__))
+#define glLoadMatrixf(...) (glcount::state(), glLoadMatrixf(__VA_ARGS__))
+#define glLoadIdentity(...) (glcount::state(), glLoadIdentity(__VA_ARGS__))
+#define glPushMatrix(...) (glcount::state(), glPushMatrix(__VA_ARGS__))
+#define glPopMatrix(...) (glcount::state(), glPopMatrix(__VA_ARGS__))
+#define glTranslatef(...) (glcount::state(), glTranslatef(__VA_ARGS__))
+#define glRotatef(...) (glcount::state(), glRotatef(__VA_ARGS__))
+#define glScalef(...) (glcount::state(), glScalef(__VA_ARGS__))
+#define glEnableClientState(...) (glcount::state(), glEnableClientState(__VA_ARGS__))
+#define glDisableClientState(...) (glcount::state(), glDisableClientState(__VA_ARGS__))
+#define glVertexPointer(...) (glcount::state(), glVertexPointer(__VA_ARGS__))
+#define glColorPointer(...) (glcount::state(), glColorPointer(__VA_ARGS__))
+#define glScissor(...) (glcount::state(), glScissor(__VA_ARGS__))
+#define glRasterPos2f(...) (glcount::state(), glRasterPos2f(__VA_ARGS__))
+
+#define glDrawArrays(mode, first, count) (glcount::draw(count), glDrawArrays(mode, first, count))
+#define glDrawPixels(...) (glcount::draw(0), glDrawPixels(__VA_ARGS__))
+#define glClear(...) (glcount::call(), glClear(__VA_ARGS__))
+
+#else
+
+inline bool glCountersBuilt() { return false; }
+inline void glCounterSubsystem(unsigned) {}
+inline void glCountersEndFrame() {}
+inline GLCallCounts glCountersLastFrame(int) { return GLCallCounts(); }
+
+#endif
+
+#endif
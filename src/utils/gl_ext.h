@@ -0,0 +1,283 @@
+// ======================
+// GL Extension Loader
+// ======================
+// opengl32.dll on Windows only exports GL 1.1, so anything newer (buffer
+// objects, shaders) is resolved at runtime. Entry points live in the glext
+// namespace to stay clear of the prototypes some platform headers declare.
+// Call loadGLExtensions() once a context is current; every feature has a
+// has* flag so callers can fall back to GL 1.1 paths.
+
+#ifndef COSMIC_GL_EXT_H
+#define COSMIC_GL_EXT_H
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/glut.h>
+#include <GL/glext.h>
+#include <cstring>
+#ifndef _WIN32
+#include <GL/glx.h>
+#endif
+#include "gl_counters.h"
+
+namespace glext {
+
+typedef void* (*ProcResolver)(const char* name);
+
+// ----------------------
+// Buffer objects (GL 1.5)
+// ----------------------
+extern PFNGLGENBUFFERSPROC GenBuffers;
+extern PFNGLDELETEBUFFERSPROC DeleteBuffers;
+extern PFNGLBINDBUFFERPROC BindBuffer;
+extern PFNGLBUFFERDATAPROC BufferData;
+extern PFNGLBUFFERSUBDATAPROC BufferSubData;
+
+extern bool hasBuffers;
+
+// GL 1.4 - null when missing, callers loop over glDrawArrays instead
+extern PFNGLMULTIDRAWARRAYSPROC MultiDrawArrays;
+
+// ----------------------
+// Shaders (GL 2.0)
+// ----------------------
+extern PFNGLCREATESHADERPROC CreateShader;
+extern PFNGLDELETESHADERPROC DeleteShader;
+extern PFNGLSHADERSOURCEPROC ShaderSource;
+extern PFNGLCOMPILESHADERPROC CompileShader;
+extern PFNGLGETSHADERIVPROC GetShaderiv;
+extern PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog;
+extern PFNGLCREATEPROGRAMPROC CreateProgram;
+extern PFNGLDELETEPROGRAMPROC DeleteProgram;
+extern PFNGLATTACHSHADERPROC AttachShader;
+extern PFNGLLINKPROGRAMPROC LinkProgram;
+extern PFNGLGETPROGRAMIVPROC GetProgramiv;
+extern PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog;
+extern PFNGLUSEPROGRAMPROC UseProgram;
+extern PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+extern PFNGLUNIFORM1FPROC Uniform1f;
+extern PFNGLGETATTRIBLOCATIONPROC GetAttribLocation;
+extern PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+extern PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+extern PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray;
+
+extern bool hasShaders;
+
+// ----------------------
+// Framebuffer objects (GL 3.0 / ARB_framebuffer_object)
+// ----------------------
+extern PFNGLGENFRAMEBUFFERSPROC GenFramebuffers;
+extern PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers;
+extern PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
+extern PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus;
+extern PFNGLFRAMEBUFFERRENDERBUFFERPROC FramebufferRenderbuffer;
+extern PFNGLGENRENDERBUFFERSPROC GenRenderbuffers;
+extern PFNGLDELETERENDERBUFFERSPROC DeleteRenderbuffers;
+extern PFNGLBINDRENDERBUFFERPROC BindRenderbuffer;
+extern PFNGLRENDERBUFFERSTORAGEPROC RenderbufferStorage;
+extern PFNGLBLITFRAMEBUFFERPROC BlitFramebuffer;
+
+extern bool hasFramebuffers;
+
+// ----------------------
+// Timer queries (GL 3.3 / ARB_timer_query)
+// ----------------------
+extern PFNGLGENQUERIESPROC GenQueries;
+extern PFNGLDELETEQUERIESPROC DeleteQueries;
+extern PFNGLBEGINQUERYPROC BeginQuery;
+extern PFNGLENDQUERYPROC EndQuery;
+extern PFNGLGETQUERYOBJECTIVPROC GetQueryObjectiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v;
+
+extern bool hasTimerQueries;
+
+inline void* defaultResolver(const char* name) {
+#ifdef _WIN32
+    return (void*)wglGetProcAddress(name);
+#else
+    return (void*)glXGetProcAddressARB((const GLubyte*)name);
+#endif
+}
+
+#ifdef COSMIC_GL_COUNTERS
+// ----------------------
+// Counting thunks for the per-frame entry points (gl_counters.h)
+// ----------------------
+namespace counted {
+inline PFNGLMULTIDRAWARRAYSPROC& realMultiDrawArrays() { static PFNGLMULTIDRAWARRAYSPROC fn; return fn; }
+inline PFNGLBINDBUFFERPROC& realBindBuffer() { static PFNGLBINDBUFFERPROC fn; return fn; }
+inline PFNGLBUFFERDATAPROC& realBufferData() { static PFNGLBUFFERDATAPROC fn; return fn; }
+inline PFNGLUSEPROGRAMPROC& realUseProgram() { static PFNGLUSEPROGRAMPROC fn; return fn; }
+inline PFNGLUNIFORM1FPROC& realUniform1f() { static PFNGLUNIFORM1FPROC fn; return fn; }
+
+inline void APIENTRY multiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei ranges) {
+    long vertices = 0;
+    for (GLsizei i = 0; i < ranges; i++) vertices += count[i];
+    glcount::draw(vertices);
+    realMultiDrawArrays()(mode, first, count, ranges);
+}
+inline void APIENTRY bindBuffer(GLenum target, GLuint buffer) {
+    glcount::state();
+    realBindBuffer()(target, buffer);
+}
+inline void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    glcount::call();
+    realBufferData()(target, size, data, usage);
+}
+inline void APIENTRY useProgram(GLuint program) {
+    glcount::state();
+    realUseProgram()(program);
+}
+inline void APIENTRY uniform1f(GLint location, GLfloat value) {
+    glcount::state();
+    realUniform1f()(location, value);
+}
+
+template <typename T>
+inline void wrap(T& entry, T& real, T thunk) {
+    if (!entry || entry == thunk) return;   // missing, or already wrapped
+    real = entry;
+    entry = thunk;
+}
+} // namespace counted
+#endif
+
+template <typename T>
+inline bool resolve(T& fn, const char* name, ProcResolver resolver) {
+    fn = (T)resolver(name);
+    return fn != nullptr;
+}
+
+// Returns true when buffer objects are available (shader, framebuffer and
+// timer query support are reported in hasShaders / hasFramebuffers /
+// hasTimerQueries). Safe to call again after a context change.
+inline bool loadGLExtensions(ProcResolver resolver = defaultResolver) {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 1, minor = 0;
+    if (version) { major = version[0] - '0'; minor = version[2] - '0'; }
+    bool gl15 = major > 1 || (major == 1 && minor >= 5);
+
+    MultiDrawArrays = nullptr;
+    if (major > 1 || (major == 1 && minor >= 4))
+        resolve(MultiDrawArrays, "glMultiDrawArrays", resolver);
+
+    hasBuffers = gl15 &&
+        resolve(GenBuffers, "glGenBuffers", resolver) &&
+        resolve(DeleteBuffers, "glDeleteBuffers", resolver) &&
+        resolve(BindBuffer, "glBindBuffer", resolver) &&
+        resolve(BufferData, "glBufferData", resolver) &&
+        resolve(BufferSubData, "glBufferSubData", resolver);
+
+    hasShaders = major >= 2 &&
+        resolve(CreateShader, "glCreateShader", resolver) &&
+        resolve(DeleteShader, "glDeleteShader", resolver) &&
+        resolve(ShaderSource, "glShaderSource", resolver) &&
+        resolve(CompileShader, "glCompileShader", resolver) &&
+        resolve(GetShaderiv, "glGetShaderiv", resolver) &&
+        resolve(GetShaderInfoLog, "glGetShaderInfoLog", resolver) &&
+        resolve(CreateProgram, "glCreateProgram", resolver) &&
+        resolve(DeleteProgram, "glDeleteProgram", resolver) &&
+        resolve(AttachShader, "glAttachShader", resolver) &&
+        resolve(LinkProgram, "glLinkProgram", resolver) &&
+        resolve(GetProgramiv, "glGetProgramiv", resolver) &&
+        resolve(GetProgramInfoLog, "glGetProgramInfoLog", resolver) &&
+        resolve(UseProgram, "glUseProgram", resolver) &&
+        resolve(GetUniformLocation, "glGetUniformLocation", resolver) &&
+        resolve(Uniform1f, "glUniform1f", resolver) &&
+        resolve(GetAttribLocation, "glGetAttribLocation", resolver) &&
+        resolve(VertexAttribPointer, "glVertexAttribPointer", resolver) &&
+        resolve(EnableVertexAttribArray, "glEnableVertexAttribArray", resolver) &&
+        resolve(DisableVertexAttribArray, "glDisableVertexAttribArray", resolver);
+
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    bool fboExtension = extensions && std::strstr(extensions, "GL_ARB_framebuffer_object");
+    hasFramebuffers = (major >= 3 || fboExtension) &&
+        resolve(GenFramebuffers, "glGenFramebuffers", resolver) &&
+        resolve(DeleteFramebuffers, "glDeleteFramebuffers", resolver) &&
+        resolve(BindFramebuffer, "glBindFramebuffer", resolver) &&
+        resolve(CheckFramebufferStatus, "glCheckFramebufferStatus", resolver) &&
+        resolve(FramebufferRenderbuffer, "glFramebufferRenderbuffer", resolver) &&
+        resolve(GenRenderbuffers, "glGenRenderbuffers", resolver) &&
+        resolve(DeleteRenderbuffers, "glDeleteRenderbuffers", resolver) &&
+        resolve(BindRenderbuffer, "glBindRenderbuffer", resolver) &&
+        resolve(RenderbufferStorage, "glRenderbufferStorage", resolver) &&
+        resolve(BlitFramebuffer, "glBlitFramebuffer", resolver);
+
+    bool timerExtension = extensions && std::strstr(extensions, "GL_ARB_timer_query");
+    hasTimerQueries = (major > 3 || (major == 3 && minor >= 3) || timerExtension) &&
+        resolve(GenQueries, "glGenQueries", resolver) &&
+        resolve(DeleteQueries, "glDeleteQueries", resolver) &&
+        resolve(BeginQuery, "glBeginQuery", resolver) &&
+        resolve(EndQuery, "glEndQuery", resolver) &&
+        resolve(GetQueryObjectiv, "glGetQueryObjectiv", resolver) &&
+        resolve(GetQueryObjectui64v, "glGetQueryObjectui64v", resolver);
+
+#ifdef COSMIC_GL_COUNTERS
+    counted::wrap(MultiDrawArrays, counted::realMultiDrawArrays(), counted::multiDrawArrays);
+    counted::wrap(BindBuffer, counted::realBindBuffer(), counted::bindBuffer);
+    counted::wrap(BufferData, counted::realBufferData(), counted::bufferData);
+    counted::wrap(UseProgram, counted::realUseProgram(), counted::useProgram);
+    counted::wrap(Uniform1f, counted::realUniform1f(), counted::uniform1f);
+#endif
+    return hasBuffers;
+}
+
+} // namespace glext
+
+// Single definition of the entry points, in the translation unit that defines
+// COSMIC_GL_EXT_IMPLEMENTATION (main.cpp), same pattern as tinyobjloader.
+#ifdef COSMIC_GL_EXT_IMPLEMENTATION
+namespace glext {
+PFNGLGENBUFFERSPROC GenBuffers = nullptr;
+PFNGLDELETEBUFFERSPROC DeleteBuffers = nullptr;
+PFNGLBINDBUFFERPROC BindBuffer = nullptr;
+PFNGLBUFFERDATAPROC BufferData = nullptr;
+PFNGLBUFFERSUBDATAPROC BufferSubData = nullptr;
+bool hasBuffers = false;
+PFNGLMULTIDRAWARRAYSPROC MultiDrawArrays = nullptr;
+
+PFNGLCREATESHADERPROC CreateShader = nullptr;
+PFNGLDELETESHADERPROC DeleteShader = nullptr;
+PFNGLSHADERSOURCEPROC ShaderSource = nullptr;
+PFNGLCOMPILESHADERPROC CompileShader = nullptr;
+PFNGLGETSHADERIVPROC GetShaderiv = nullptr;
+PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog = nullptr;
+PFNGLCREATEPROGRAMPROC CreateProgram = nullptr;
+PFNGLDELETEPROGRAMPROC DeleteProgram = nullptr;
+PFNGLATTACHSHADERPROC AttachShader = nullptr;
+PFNGLLINKPROGRAMPROC LinkProgram = nullptr;
+PFNGLGETPROGRAMIVPROC GetProgramiv = nullptr;
+PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog = nullptr;
+PFNGLUSEPROGRAMPROC UseProgram = nullptr;
+PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation = nullptr;
+PFNGLUNIFORM1FPROC Uniform1f = nullptr;
+PFNGLGETATTRIBLOCATIONPROC GetAttribLocation = nullptr;
+PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer = nullptr;
+PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray = nullptr;
+PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray = nullptr;
+bool hasShaders = false;
+
+PFNGLGENFRAMEBUFFERSPROC GenFramebuffers = nullptr;
+PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers = nullptr;
+PFNGLBINDFRAMEBUFFERPROC BindFramebuffer = nullptr;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus = nullptr;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC FramebufferRenderbuffer = nullptr;
+PFNGLGENRENDERBUFFERSPROC GenRenderbuffers = nullptr;
+PFNGLDELETERENDERBUFFERSPROC DeleteRenderbuffers = nullptr;
+PFNGLBINDRENDERBUFFERPROC BindRenderbuffer = nullptr;
+PFNGLRENDERBUFFERSTORAGEPROC RenderbufferStorage = nullptr;
+PFNGLBLITFRAMEBUFFERPROC BlitFramebuffer = nullptr;
+bool hasFramebuffers = false;
+
+PFNGLGENQUERIESPROC GenQueries = nullptr;
+PFNGLDELETEQUERIESPROC DeleteQueries = nullptr;
+PFNGLBEGINQUERYPROC BeginQuery = nullptr;
+PFNGLENDQUERYPROC EndQuery = nullptr;
+PFNGLGETQUERYOBJECTIVPROC GetQueryObjectiv = nullptr;
+PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v = nullptr;
+bool hasTimerQueries = false;
+}
+#endif
+
+#endif
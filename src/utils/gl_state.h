@@ -0,0 +1,121 @@
+// ======================
+// GL State Shadowing
+// ======================
+// Keeps a CPU-side copy of the fixed-function state the renderer touches each
+// frame (capabilities, point size, line width, colour-material mode, blend
+// function) and drops calls that would set a value the driver already holds.
+
+#ifndef COSMIC_GL_STATE_H
+#define COSMIC_GL_STATE_H
+
+#include <GL/glut.h>
+#include <GL/glext.h>
+#include "gl_counters.h"
+
+// ----------------------
+// Per-frame counters
+// ----------------------
+struct GLStateStats {
+    int issued = 0;    // calls forwarded to GL
+    int avoided = 0;   // calls dropped because the value was already set
+};
+
+class GLStateCache {
+public:
+    // Forget everything we know; the next call for each state always reaches GL.
+    // Call after initGL() or any code that changes state behind our back.
+    void invalidate() {
+        for (int i = 0; i < kNumCaps; i++) caps[i] = UNKNOWN;
+        pointSizeValue = -1.0f;
+        lineWidthValue = -1.0f;
+        colorMaterialFace = colorMaterialMode = 0;
+        blendSrc = blendDst = 0;
+    }
+
+    // Record a value we know without asking GL (e.g. a default that was
+    // never changed), so the first request for it costs nothing.
+    void assume(GLenum cap, bool on) {
+        int slot = capSlot(cap);
+        if (slot >= 0) caps[slot] = on ? ON : OFF;
+    }
+
+    void beginFrame() { frame = GLStateStats(); }
+    const GLStateStats& stats() const { return frame; }
+
+    void enable(GLenum cap)  { setCap(cap, true); }
+    void disable(GLenum cap) { setCap(cap, false); }
+
+    void setCap(GLenum cap, bool on) {
+        int slot = capSlot(cap);
+        if (slot < 0) {  // untracked capability - always forward
+            on ? glEnable(cap) : glDisable(cap);
+            frame.issued++;
+            return;
+        }
+        Tri want = on ? ON : OFF;
+        if (caps[slot] == want) { frame.avoided++; return; }
+        on ? glEnable(cap) : glDisable(cap);
+        caps[slot] = want;
+        frame.issued++;
+    }
+
+    void pointSize(float s) {
+        if (s == pointSizeValue) { frame.avoided++; return; }
+        glPointSize(s);
+        pointSizeValue = s;
+        frame.issued++;
+    }
+
+    void lineWidth(float w) {
+        if (w == lineWidthValue) { frame.avoided++; return; }
+        glLineWidth(w);
+        lineWidthValue = w;
+        frame.issued++;
+    }
+
+    void colorMaterial(GLenum face, GLenum mode) {
+        if (face == colorMaterialFace && mode == colorMaterialMode) { frame.avoided++; return; }
+        glColorMaterial(face, mode);
+        colorMaterialFace = face;
+        colorMaterialMode = mode;
+        frame.issued++;
+    }
+
+    void blendFunc(GLenum src, GLenum dst) {
+        if (src == blendSrc && dst == blendDst) { frame.avoided++; return; }
+        glBlendFunc(src, dst);
+        blendSrc = src;
+        blendDst = dst;
+        frame.issued++;
+    }
+
+private:
+    enum Tri { UNKNOWN, ON, OFF };
+    static const int kNumCaps = 10;
+
+    static int capSlot(GLenum cap) {
+        switch (cap) {
+            case GL_LIGHTING:       return 0;
+            case GL_DEPTH_TEST:     return 1;
+            case GL_COLOR_MATERIAL: return 2;
+            case GL_BLEND:          return 3;
+            case GL_LIGHT0:         return 4;
+            case GL_LIGHT1:         return 5;
+            case GL_LIGHT2:         return 6;
+            case GL_POINT_SMOOTH:   return 7;
+            case GL_POINT_SPRITE:   return 8;
+            case GL_VERTEX_PROGRAM_POINT_SIZE: return 9;
+            default:                return -1;
+        }
+    }
+
+    Tri caps[kNumCaps] = {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,
+                          UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+    float pointSizeValue = -1.0f;
+    float lineWidthValue = -1.0f;
+    GLenum colorMaterialFace = 0, colorMaterialMode = 0;
+    GLenum blendSrc = 0, blendDst = 0;
+    GLStateStats frame;
+};
+
+#endif
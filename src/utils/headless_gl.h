@@ -0,0 +1,124 @@
+// ======================
+// Headless GL Context
+// ======================
+// An OpenGL context with no window, for --headless runs in containers and
+// on CI machines without a display server. Only built with
+// -DCOSMIC_HEADLESS (link with -lEGL):
+//   - Mesa's surfaceless platform is tried first (llvmpipe needs no X11,
+//     Wayland or GPU), then the default EGL display,
+//   - the context renders into a pbuffer of the requested size, so the
+//     default framebuffer, glReadPixels and the retained frame work as they
+//     do in a window,
+//   - where no pbuffer config exists the context is made current with no
+//     surface and needsFramebuffer() asks the caller to bind an FBO.
+// Without the flag create() fails and reports how to build it in.
+
+#ifndef COSMIC_HEADLESS_GL_H
+#define COSMIC_HEADLESS_GL_H
+
+#include <string>
+
+#ifdef COSMIC_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+
+class HeadlessContext {
+public:
+    ~HeadlessContext() { release(); }
+
+    // Makes a desktop GL context current; false (see error()) if none
+    bool create(int width, int height) {
+        release();
+        if (!eglBindAPI(EGL_OPENGL_API)) return fail("EGL has no desktop OpenGL");
+
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = nullptr;
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless"))
+            getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay && open(getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr),
+                                       width, height, "EGL surfaceless"))
+            return true;
+        if (open(eglGetDisplay(EGL_DEFAULT_DISPLAY), width, height, "EGL default display")) return true;
+        return false;
+    }
+
+    void release() {
+        if (display == EGL_NO_DISPLAY) return;
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+        context = EGL_NO_CONTEXT;
+        surface = EGL_NO_SURFACE;
+    }
+
+    // No default framebuffer: render into an FBO instead
+    bool needsFramebuffer() const { return surface == EGL_NO_SURFACE; }
+
+    const std::string& description() const { return info; }
+    const std::string& error() const { return failure; }
+
+    // For glext::loadGLExtensions()
+    static void* resolve(const char* name) { return (void*)eglGetProcAddress(name); }
+
+private:
+    bool open(EGLDisplay d, int width, int height, const char* platform) {
+        if (d == EGL_NO_DISPLAY || !eglInitialize(d, nullptr, nullptr)) return fail("no EGL display");
+        display = d;
+        static const EGLint pbufferConfig[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE,
+                                               EGL_OPENGL_BIT, EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8,
+                                               EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_DEPTH_SIZE, 24,
+                                               EGL_NONE};
+        static const EGLint anyConfig[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+        EGLConfig config;
+        EGLint count = 0;
+        bool pbuffer = eglChooseConfig(display, pbufferConfig, &config, 1, &count) && count > 0;
+        if (!pbuffer && !(eglChooseConfig(display, anyConfig, &config, 1, &count) && count > 0)) {
+            release();
+            return fail("no desktop OpenGL config");
+        }
+        if (pbuffer) {
+            const EGLint size[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+            surface = eglCreatePbufferSurface(display, config, size);
+        }
+        // Compatibility profile: the renderer is fixed-function GL
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+        if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context)) {
+            release();
+            return fail("could not make an OpenGL context current");
+        }
+        info = std::string(platform) + (surface != EGL_NO_SURFACE ? ", pbuffer" : ", no surface (FBO)");
+        return true;
+    }
+
+    bool fail(const char* why) {
+        failure = why;
+        return false;
+    }
+
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+    std::string info, failure;
+};
+
+#else
+
+class HeadlessContext {
+public:
+    bool create(int, int) { return false; }
+    void release() {}
+    bool needsFramebuffer() const { return false; }
+    const std::string& description() const { return failure; }
+    const std::string& error() const { return failure; }
+    static void* resolve(const char*) { return nullptr; }
+
+private:
+    std::string failure = "built without headless support (-DCOSMIC_HEADLESS, link -lEGL)";
+};
+
+#endif
+
+#endif
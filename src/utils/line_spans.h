@@ -0,0 +1,128 @@
+// ======================
+// Cached Line Spans
+// ======================
+// Bresenham lines as runs along their major axis (raster::lineSpans in
+// src/algorithms/raster.h), kept per segment in one contiguous buffer.
+// A segment is only re-rasterised when its endpoints change. With a clip
+// rectangle set, only the part of each segment inside it is rasterised.
+
+#ifndef COSMIC_LINE_SPANS_H
+#define COSMIC_LINE_SPANS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "../algorithms/raster.h"
+
+// ----------------------
+// Per-segment span cache
+// ----------------------
+// Segments are addressed by index. Each owns a slot in one shared span
+// buffer; a changed segment is re-rasterised in place when it still fits,
+// otherwise appended, and the buffer is compacted once holes dominate.
+class LineSpanCache {
+public:
+    struct Stats {
+        size_t hits = 0, misses = 0, compactions = 0;
+    };
+
+    // Batch update: make the cache hold exactly these segments. Returns the
+    // number of segments that had to be rasterised.
+    size_t update(const LineSegment* segments, size_t count) {
+        if (entries.size() > count) {
+            for (size_t i = count; i < entries.size(); i++) garbage += entries[i].capacity;
+            entries.resize(count);
+        }
+        size_t rasterised = 0;
+        for (size_t i = 0; i < count; i++)
+            if (set(i, segments[i])) rasterised++;
+        if (garbage > spans.size() / 2) compact();
+        return rasterised;
+    }
+
+    // Single segment; returns true when it was (re)rasterised
+    bool set(size_t index, const LineSegment& seg) {
+        if (index >= entries.size()) entries.resize(index + 1);
+        Entry& e = entries[index];
+        if (e.valid && e.segment == seg) {
+            stats.hits++;
+            return false;
+        }
+        stats.misses++;
+
+        scratch.clear();
+        if (clipped)
+            raster::clippedLineSpans(seg.x0, seg.y0, seg.x1, seg.y1, clip, scratch);
+        else
+            raster::lineSpans(seg.x0, seg.y0, seg.x1, seg.y1, scratch);
+        if (scratch.size() > e.capacity) {
+            garbage += e.capacity;
+            e.first = (uint32_t)spans.size();
+            e.capacity = (uint32_t)scratch.size();
+            spans.resize(spans.size() + scratch.size());
+        }
+        std::copy(scratch.begin(), scratch.end(), spans.begin() + e.first);
+        e.count = (uint32_t)scratch.size();
+        e.segment = seg;
+        e.valid = true;
+        return true;
+    }
+
+    void clear() {
+        entries.clear();
+        spans.clear();
+        garbage = 0;
+    }
+
+    // Clip every segment to `rect`; changing it drops the cached spans
+    void setClip(const raster::ClipRect& rect) {
+        if (clipped && rect.xmin == clip.xmin && rect.ymin == clip.ymin &&
+            rect.xmax == clip.xmax && rect.ymax == clip.ymax)
+            return;
+        clear();
+        clip = rect;
+        clipped = true;
+    }
+
+    size_t size() const { return entries.size(); }
+    const LineSpan* segmentSpans(size_t index) const { return spans.data() + entries[index].first; }
+    size_t segmentSpanCount(size_t index) const { return entries[index].count; }
+    size_t spanBufferSize() const { return spans.size(); }
+    const Stats& statistics() const { return stats; }
+
+    template <typename Sink>
+    void pixels(size_t index, Sink& sink) const {
+        raster::spanPixels(segmentSpans(index), segmentSpanCount(index), sink);
+    }
+
+private:
+    struct Entry {
+        LineSegment segment = {0, 0, 0, 0};
+        uint32_t first = 0, count = 0, capacity = 0;
+        bool valid = false;
+    };
+
+    void compact() {
+        std::vector<LineSpan> packed;
+        packed.reserve(spans.size() - garbage);
+        for (Entry& e : entries) {
+            uint32_t first = (uint32_t)packed.size();
+            packed.insert(packed.end(), spans.begin() + e.first, spans.begin() + e.first + e.count);
+            e.first = first;
+            e.capacity = e.count;
+        }
+        spans.swap(packed);
+        garbage = 0;
+        stats.compactions++;
+    }
+
+    std::vector<Entry> entries;
+    std::vector<LineSpan> spans;
+    std::vector<LineSpan> scratch;
+    size_t garbage = 0;     // spans no entry owns any more
+    raster::ClipRect clip = {0, 0, 0, 0};
+    bool clipped = false;
+    Stats stats;
+};
+
+#endif
@@ -0,0 +1,88 @@
+// ======================
+// Batched Orbit Rasterisation
+// ======================
+// Keplerian orbits projected onto the floor: an ellipse with the Sun at one
+// focus, turned towards its periapsis. Each orbit is rounded to integer
+// semi-axes and focal distance and drawn by raster::orbit (midpoint ellipse,
+// 4-way symmetry, fixed-point rotation), so thousands of asteroid or comet
+// orbits fill one point buffer with no trigonometry per pixel.
+
+#ifndef COSMIC_ORBIT_BATCH_H
+#define COSMIC_ORBIT_BATCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "../algorithms/raster.h"
+
+struct OrbitElements {
+    float semiMajor;        // floor units
+    float eccentricity;     // 0 <= e < 1
+    float periapsis;        // direction of periapsis, radians from +x
+    float focusX, focusY;   // the body being orbited
+};
+
+// Integer form used by the rasteriser
+struct OrbitShape {
+    int xf, yf;
+    int a, b, c;            // semi-major, semi-minor, focal distance
+    raster::Rotation rot;
+};
+
+inline raster::Rotation orbitRotation(float radians) {
+    return raster::Rotation{(int)std::lround(std::cos(radians) * (1 << 14)),
+                            (int)std::lround(std::sin(radians) * (1 << 14))};
+}
+
+inline OrbitShape orbitShape(const OrbitElements& o) {
+    float e = std::min(std::max(o.eccentricity, 0.0f), 0.999f);
+    OrbitShape s;
+    s.xf = (int)std::lround(o.focusX);
+    s.yf = (int)std::lround(o.focusY);
+    s.a = std::max(0, (int)std::lround(o.semiMajor));
+    s.b = (int)std::lround(o.semiMajor * std::sqrt(1.0f - e * e));
+    s.c = (int)std::lround(o.semiMajor * e);
+    s.rot = orbitRotation(o.periapsis);
+    return s;
+}
+
+// Upper bound on the pixels raster::orbit writes: four chains of at most
+// a + b + 1 quadrant steps, each joined by a line of at most two pixels
+inline size_t orbitPointBound(const OrbitShape& s) {
+    return 8 * ((size_t)s.a + s.b + 2);
+}
+
+// Writes straight into a buffer already sized by orbitPointBound
+struct RawPointSink {
+    raster::Point* out;
+    void point(int x, int y) { *out++ = raster::Point{x, y}; }
+};
+
+// Append many orbits to one buffer; orbit i ends up in
+// [firsts[i], firsts[i + 1]) when `firsts` started empty (one entry per
+// orbit is appended, plus the end).
+inline void appendOrbits(const OrbitShape* orbits, size_t count, std::vector<raster::Point>& out,
+                         std::vector<uint32_t>& firsts) {
+    size_t at = out.size();
+    if (firsts.empty()) firsts.push_back((uint32_t)at);
+    for (size_t i = 0; i < count; i++) {
+        const OrbitShape& s = orbits[i];
+        size_t bound = orbitPointBound(s);
+        if (out.size() < at + bound) out.resize(std::max(at + bound, out.size() * 2));
+        RawPointSink sink{out.data() + at};
+        raster::orbit(s.xf, s.yf, s.a, s.b, s.c, s.rot, sink);
+        at = sink.out - out.data();
+        firsts.push_back((uint32_t)at);
+    }
+    out.resize(at);
+}
+
+inline void appendOrbits(const OrbitElements* orbits, size_t count, std::vector<raster::Point>& out,
+                         std::vector<uint32_t>& firsts) {
+    std::vector<OrbitShape> shapes(count);
+    for (size_t i = 0; i < count; i++) shapes[i] = orbitShape(orbits[i]);
+    appendOrbits(shapes.data(), count, out, firsts);
+}
+
+#endif
@@ -0,0 +1,210 @@
+// ======================
+// Render Queue
+// ======================
+// Subsystems submit draw items tagged with a 64-bit sort key instead of issuing
+// GL state changes themselves. Once per frame the queue radix-sorts the keys and
+// replays the items, applying the state encoded in each key through a
+// GLStateCache so only real transitions reach the driver.
+//
+// Key layout (most significant first):
+//   63..56  pass          sky, then overlay, then 3D
+//   55..48  layer         painter's order inside a pass drawn without depth
+//                         test; outranks state so batching never restacks it
+//   47..40  raster state  depth test, lighting, colour material, primitive type,
+//                         blending, point sprites
+//   39..24  material id   only bound for lit items
+//   23..8   size          point size / line width, 8.8 fixed point
+//   7..0    order         free for the subsystem (stable sort keeps submit order)
+
+#ifndef COSMIC_RENDER_QUEUE_H
+#define COSMIC_RENDER_QUEUE_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "gl_state.h"
+
+enum RenderPass {
+    PASS_SKY     = 0,   // catalog stars on the celestial sphere
+    PASS_OVERLAY = 1,   // floor grid, constellations, planets, stars
+    PASS_OPAQUE  = 2,   // lit 3D geometry (telescope)
+    PASS_NONE    = 0xFF // given to the pass hook after the last item
+};
+
+enum RenderStateBits {
+    RS_LINES          = 1 << 0,  // size field is a line width, not a point size
+    RS_COLOR_MATERIAL = 1 << 1,
+    RS_LIGHTING       = 1 << 2,
+    RS_DEPTH_TEST     = 1 << 3,
+    RS_ADDITIVE       = 1 << 4,  // additive blending instead of alpha blending
+    RS_POINT_SPRITE   = 1 << 5,  // shader-sized point sprites (no GL_POINT_SMOOTH)
+    RS_NO_SMOOTH      = 1 << 6   // coverage is already in vertex alpha (Wu lines)
+};
+
+struct DrawItem;
+typedef void (*DrawFn)(const DrawItem& item);
+
+struct DrawItem {
+    uint64_t key;
+    DrawFn draw;
+    const void* data;   // subsystem payload, not owned
+    int first;          // subsystem-defined range
+    int count;
+    unsigned tag;       // submitting subsystem, for the GL call counters
+};
+
+inline uint64_t makeSortKey(unsigned pass, unsigned layer, unsigned state, unsigned material,
+                            float size, unsigned order = 0) {
+    unsigned fixedSize = (unsigned)(size * 256.0f + 0.5f);
+    if (fixedSize > 0xFFFF) fixedSize = 0xFFFF;
+    return ((uint64_t)(pass & 0xFF) << 56) |
+           ((uint64_t)(layer & 0xFF) << 48) |
+           ((uint64_t)(state & 0xFF) << 40) |
+           ((uint64_t)(material & 0xFFFF) << 24) |
+           ((uint64_t)fixedSize << 8) |
+           (uint64_t)(order & 0xFF);
+}
+
+inline unsigned sortKeyPass(uint64_t key)     { return (unsigned)(key >> 56) & 0xFF; }
+inline unsigned sortKeyLayer(uint64_t key)    { return (unsigned)(key >> 48) & 0xFF; }
+inline unsigned sortKeyState(uint64_t key)    { return (unsigned)(key >> 40) & 0xFF; }
+inline unsigned sortKeyMaterial(uint64_t key) { return (unsigned)(key >> 24) & 0xFFFF; }
+inline float    sortKeySize(uint64_t key)     { return ((unsigned)(key >> 8) & 0xFFFF) / 256.0f; }
+
+// ----------------------
+// Per-frame counters
+// ----------------------
+struct RenderQueueStats {
+    int items = 0;
+    int materialBinds = 0;
+    int materialBindsAvoided = 0;
+    int sortPasses = 0;          // radix passes actually run (uniform bytes skipped)
+    GLStateStats state;
+};
+
+class RenderQueue {
+public:
+    typedef void (*MaterialBinder)(unsigned material);
+    typedef void (*PassHook)(unsigned pass);
+
+    void setMaterialBinder(MaterialBinder binder) { bindMaterial = binder; }
+    // Called as flush() reaches each pass that has items, then with
+    // PASS_NONE after the last one (the frame profiler times passes)
+    void setPassHook(PassHook hook) { passHook = hook; }
+
+    void clear() { items.clear(); }
+
+    // Subsystem recorded with every following submit (GLSubsystem in
+    // gl_counters.h); flush() attributes each item's GL calls to it
+    void setTag(unsigned tag) { currentTag = tag; }
+
+    void submit(uint64_t key, DrawFn draw, const void* data = nullptr,
+                int first = 0, int count = 0) {
+        DrawItem item = {key, draw, data, first, count, currentTag};
+        items.push_back(item);
+    }
+
+    // Sort, apply state and draw everything submitted this frame.
+    void flush(GLStateCache& gl) {
+        gl.beginFrame();
+        lastStats = RenderQueueStats();
+        lastStats.items = (int)items.size();
+
+        sortItems();
+
+        bool haveMaterial = false;
+        unsigned boundMaterial = 0;
+        unsigned pass = PASS_NONE;
+        for (size_t i = 0; i < order.size(); i++) {
+            const DrawItem& item = items[order[i]];
+            unsigned state = sortKeyState(item.key);
+            glCounterSubsystem(item.tag);
+            if (passHook && sortKeyPass(item.key) != pass) {
+                pass = sortKeyPass(item.key);
+                passHook(pass);
+            }
+
+            gl.setCap(GL_DEPTH_TEST, (state & RS_DEPTH_TEST) != 0);
+            gl.setCap(GL_LIGHTING, (state & RS_LIGHTING) != 0);
+            gl.setCap(GL_COLOR_MATERIAL, (state & RS_COLOR_MATERIAL) != 0);
+            if (state & RS_COLOR_MATERIAL)
+                gl.colorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+            if (state & RS_ADDITIVE) gl.blendFunc(GL_SRC_ALPHA, GL_ONE);
+            else gl.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+            bool sprites = (state & RS_POINT_SPRITE) != 0;
+            gl.setCap(GL_POINT_SPRITE, sprites);
+            gl.setCap(GL_VERTEX_PROGRAM_POINT_SIZE, sprites);
+            gl.setCap(GL_POINT_SMOOTH, !sprites && !(state & RS_NO_SMOOTH));
+
+            float size = sortKeySize(item.key);
+            if (size > 0.0f) {
+                if (state & RS_LINES) gl.lineWidth(size);
+                else gl.pointSize(size);
+            }
+
+            if ((state & RS_LIGHTING) && bindMaterial) {
+                unsigned material = sortKeyMaterial(item.key);
+                if (haveMaterial && material == boundMaterial) {
+                    lastStats.materialBindsAvoided++;
+                } else {
+                    bindMaterial(material);
+                    boundMaterial = material;
+                    haveMaterial = true;
+                    lastStats.materialBinds++;
+                }
+            }
+
+            item.draw(item);
+        }
+        if (passHook && pass != PASS_NONE) passHook(PASS_NONE);
+        glCounterSubsystem(GLSUB_OTHER);
+        currentTag = GLSUB_OTHER;
+
+        lastStats.state = gl.stats();
+        items.clear();
+    }
+
+    const RenderQueueStats& stats() const { return lastStats; }
+
+private:
+    // LSD radix sort on (key, index), 8 bits per pass. Passes where every key
+    // has the same byte are skipped, which for our keys removes most of them.
+    void sortItems() {
+        size_t n = items.size();
+        order.resize(n);
+        scratch.resize(n);
+        keys.resize(n);
+        keyScratch.resize(n);
+        for (size_t i = 0; i < n; i++) { order[i] = (uint32_t)i; keys[i] = items[i].key; }
+        if (n < 2) return;
+
+        for (int shift = 0; shift < 64; shift += 8) {
+            uint32_t counts[256];
+            std::memset(counts, 0, sizeof(counts));
+            for (size_t i = 0; i < n; i++) counts[(keys[i] >> shift) & 0xFF]++;
+            if (counts[(keys[0] >> shift) & 0xFF] == n) continue;
+
+            uint32_t sum = 0;
+            for (int b = 0; b < 256; b++) { uint32_t c = counts[b]; counts[b] = sum; sum += c; }
+            for (size_t i = 0; i < n; i++) {
+                uint32_t dst = counts[(keys[i] >> shift) & 0xFF]++;
+                keyScratch[dst] = keys[i];
+                scratch[dst] = order[i];
+            }
+            keys.swap(keyScratch);
+            order.swap(scratch);
+            lastStats.sortPasses++;
+        }
+    }
+
+    std::vector<DrawItem> items;
+    std::vector<uint32_t> order, scratch;
+    std::vector<uint64_t> keys, keyScratch;
+    MaterialBinder bindMaterial = nullptr;
+    PassHook passHook = nullptr;
+    unsigned currentTag = GLSUB_OTHER;
+    RenderQueueStats lastStats;
+};
+
+#endif
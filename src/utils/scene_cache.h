@@ -0,0 +1,202 @@
+// ======================
+// Static Scene Cache
+// ======================
+// The floor overlay (grid, constellations, orbits, planets...) only changes
+// when a setting changes, so each layer is generated once into a vertex buffer
+// and replayed every frame with a single glDrawArrays. Layers are rebuilt
+// lazily: markDirty() flags one, and the next frame that draws it rebuilds
+// just that layer.
+//
+// Without buffer object support the same vertex data is drawn from client
+// memory with GL 1.1 vertex arrays.
+
+#ifndef COSMIC_SCENE_CACHE_H
+#define COSMIC_SCENE_CACHE_H
+
+#include <cstdint>
+#include <vector>
+#include "gl_ext.h"
+
+// Interleaved vertex: 12 bytes position + 4 bytes colour
+struct SceneVertex {
+    float x, y, z;
+    uint8_t r, g, b, a;
+};
+
+// ----------------------
+// Layer builder
+// ----------------------
+// Mirrors glColor3f/glVertex3f so layer code reads like immediate mode.
+class SceneLayerBuilder {
+public:
+    explicit SceneLayerBuilder(std::vector<SceneVertex>& out) : out(out) {}
+
+    void reserve(size_t n) { out.reserve(out.size() + n); }
+
+    // Index of the next vertex - bracket sub-ranges for SceneLayer::draw(ranges)
+    GLint mark() const { return (GLint)out.size(); }
+
+    void color(float red, float green, float blue) {
+        r = toByte(red); g = toByte(green); b = toByte(blue);
+    }
+
+    void vertex(float x, float y, float z) {
+        SceneVertex v = {x, y, z, r, g, b, 255};
+        out.push_back(v);
+    }
+
+    // Partially covered vertex (anti-aliased lines): coverage goes in alpha
+    void vertex(float x, float y, float z, uint8_t alpha) {
+        SceneVertex v = {x, y, z, r, g, b, alpha};
+        out.push_back(v);
+    }
+
+private:
+    static uint8_t toByte(float c) {
+        if (c <= 0.0f) return 0;
+        if (c >= 1.0f) return 255;
+        return (uint8_t)(c * 255.0f + 0.5f);
+    }
+
+    std::vector<SceneVertex>& out;
+    uint8_t r = 255, g = 255, b = 255;
+};
+
+// Raster sink (src/algorithms/raster.h) that lays 2D output on the floor:
+// pixel (x, y) becomes vertex (x, height, y), partial coverage its alpha;
+// segments become a GL_LINES pair.
+struct FloorPlaneSink {
+    SceneLayerBuilder& out;
+    float height;
+
+    FloorPlaneSink(SceneLayerBuilder& out, float height) : out(out), height(height) {}
+
+    void point(int x, int y) { out.vertex((float)x, height, (float)y); }
+    void coverage(int x, int y, int weight) {
+        out.vertex((float)x, height, (float)y, (uint8_t)weight);
+    }
+    void segment(int x0, int y0, int x1, int y1) {
+        out.vertex((float)x0, height, (float)y0);
+        out.vertex((float)x1, height, (float)y1);
+    }
+};
+
+typedef void (*SceneLayerBuildFn)(SceneLayerBuilder& out);
+
+// ----------------------
+// One cached layer
+// ----------------------
+class SceneLayer {
+public:
+    SceneLayer(GLenum primitive, SceneLayerBuildFn build)
+        : primitive(primitive), build(build) {}
+
+    ~SceneLayer() { release(); }
+
+    void markDirty() { dirty = true; }
+    bool isDirty() const { return dirty; }
+    size_t vertexCount() const { return count; }
+    GLenum primitiveType() const { return primitive; }
+
+    // Box around the vertices of the last build; false while empty
+    bool bounds(float lo[3], float hi[3]) const {
+        if (count == 0) return false;
+        for (int k = 0; k < 3; k++) { lo[k] = boxLo[k]; hi[k] = boxHi[k]; }
+        return true;
+    }
+
+    // Vertices still in system memory: always without VBOs (and without a GL
+    // context, e.g. --render-overlay), nullptr once upload() handed them over
+    const SceneVertex* clientVertices() const { return vertices.empty() ? nullptr : vertices.data(); }
+
+    // Rebuilds if dirty; returns true when a rebuild happened.
+    bool update() {
+        if (!dirty) return false;
+        vertices.clear();
+        SceneLayerBuilder builder(vertices);
+        build(builder);
+        count = vertices.size();
+        measure();
+        upload();
+        dirty = false;
+        rebuilds++;
+        return true;
+    }
+
+    void draw() const {
+        GLint first = 0;
+        GLsizei n = (GLsizei)count;
+        draw(&first, &n, 1);
+    }
+
+    // Draw several sub-ranges (from SceneLayerBuilder::mark) in one call
+    void draw(const GLint* firsts, const GLsizei* counts, int ranges) const {
+        if (count == 0 || ranges == 0) return;
+        const char* base = (const char*)vertices.data();
+        if (vbo) {
+            glext::BindBuffer(GL_ARRAY_BUFFER, vbo);
+            base = nullptr;
+        }
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(3, GL_FLOAT, sizeof(SceneVertex), base);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(SceneVertex), base + 12);
+        if (glext::MultiDrawArrays) {
+            glext::MultiDrawArrays(primitive, firsts, counts, ranges);
+        } else {
+            for (int i = 0; i < ranges; i++) glDrawArrays(primitive, firsts[i], counts[i]);
+        }
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        if (vbo) glext::BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Drop the GPU copy (context teardown); the next update() rebuilds it.
+    void release() {
+        if (vbo && glext::hasBuffers) glext::DeleteBuffers(1, &vbo);
+        vbo = 0;
+        dirty = true;
+    }
+
+    int rebuildCount() const { return rebuilds; }
+
+private:
+    void measure() {
+        if (vertices.empty()) return;
+        boxLo[0] = boxHi[0] = vertices[0].x;
+        boxLo[1] = boxHi[1] = vertices[0].y;
+        boxLo[2] = boxHi[2] = vertices[0].z;
+        for (const SceneVertex& v : vertices) {
+            boxLo[0] = v.x < boxLo[0] ? v.x : boxLo[0];
+            boxLo[1] = v.y < boxLo[1] ? v.y : boxLo[1];
+            boxLo[2] = v.z < boxLo[2] ? v.z : boxLo[2];
+            boxHi[0] = v.x > boxHi[0] ? v.x : boxHi[0];
+            boxHi[1] = v.y > boxHi[1] ? v.y : boxHi[1];
+            boxHi[2] = v.z > boxHi[2] ? v.z : boxHi[2];
+        }
+    }
+
+    void upload() {
+        if (!glext::hasBuffers) return;
+        if (!vbo) glext::GenBuffers(1, &vbo);
+        glext::BindBuffer(GL_ARRAY_BUFFER, vbo);
+        glext::BufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SceneVertex),
+                          vertices.data(), GL_STATIC_DRAW);
+        glext::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // The GPU owns the data now; large layers (star fields) would
+        // otherwise hold a second copy in system memory.
+        std::vector<SceneVertex>().swap(vertices);
+    }
+
+    GLenum primitive;
+    SceneLayerBuildFn build;
+    std::vector<SceneVertex> vertices;   // staging, and the draw source without VBOs
+    size_t count = 0;
+    float boxLo[3] = {0, 0, 0}, boxHi[3] = {0, 0, 0};
+    GLuint vbo = 0;
+    bool dirty = true;
+    int rebuilds = 0;
+};
+
+#endif
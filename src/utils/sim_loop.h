@@ -0,0 +1,118 @@
+// ======================
+// Fixed-Timestep Simulation
+// ======================
+// The pieces of the main loop that do not touch GLUT:
+//   - KeyState: which keys are held, from key down / key up callbacks, so
+//     movement no longer depends on the OS auto-repeat rate,
+//   - FixedStepClock: turns real elapsed time into a whole number of fixed
+//     simulation steps plus the leftover fraction used to interpolate the
+//     rendered frame, and keeps the time-warped simulation time that
+//     animations read,
+//   - CameraMotion: velocity and turn rate that ease toward what the held
+//     keys ask for, integrated once per step.
+// main.cpp drives them from a GLUT timer at the target frame rate, so a
+// burst of input events can no longer cause a burst of redraws.
+
+#ifndef COSMIC_SIM_LOOP_H
+#define COSMIC_SIM_LOOP_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include "camera.h"
+
+class KeyState {
+public:
+    // Letters are folded to lower case; shift can change between down and up
+    void press(unsigned char key) { down[fold(key)] = true; }
+    void release(unsigned char key) { down[fold(key)] = false; }
+    void clear() { std::fill(down, down + 256, false); }
+    bool held(unsigned char key) const { return down[fold(key)]; }
+
+private:
+    static unsigned char fold(unsigned char key) { return (unsigned char)std::tolower(key); }
+    bool down[256] = {};
+};
+
+class FixedStepClock {
+public:
+    double step = 1.0 / 120.0;   // seconds of simulation per step
+    int maxSteps = 12;           // per advance(); beyond this the simulation slows instead of spiralling
+    double timeWarp = 1.0;       // simulation seconds per real second for animations (0 = paused)
+
+    // Add real elapsed time; returns how many steps to run now
+    int advance(double realSeconds) {
+        accumulator += std::max(0.0, realSeconds);
+        int steps = (int)(accumulator / step);
+        if (steps > maxSteps) {
+            steps = maxSteps;
+            accumulator = 0.0;
+        } else {
+            accumulator -= steps * step;
+        }
+        simulationTime += steps * step * timeWarp;
+        return steps;
+    }
+
+    // How far the rendered frame lies between the last two steps
+    float alpha() const { return (float)(accumulator / step); }
+
+    // Animation time in seconds, scaled by timeWarp
+    double time() const { return simulationTime; }
+
+private:
+    double accumulator = 0.0;
+    double simulationTime = 0.0;
+};
+
+struct CameraMotionSettings {
+    float moveSpeed = 40.0f;      // units per second at full speed
+    float turnSpeed = 60.0f;      // degrees per second
+    float easeTime = 0.12f;       // seconds to cover ~63% of a speed change
+    float minHeight = 10.0f;      // the floor limit the F key always had
+};
+
+class CameraMotion {
+public:
+    CameraMotionSettings settings;
+
+    // One fixed step: ease toward the velocity the held keys ask for, then
+    // move. Returns false once the camera has come to rest.
+    bool step(Camera& camera, const KeyState& keys, float dt) {
+        Vec3 target{axis(keys, 'd', 'a'), axis(keys, 'r', 'f'), axis(keys, 's', 'w')};
+        target = target * settings.moveSpeed;
+        float targetTurn = axis(keys, 'e', 'q') * settings.turnSpeed;
+
+        float k = 1.0f - std::exp(-dt / settings.easeTime);
+        velocity += (target - velocity) * k;
+        turnRate += (targetTurn - turnRate) * k;
+        // Settle exactly so idle frames can stop redrawing
+        if (length(velocity - target) < 1e-3f) velocity = target;
+        if (std::fabs(turnRate - targetTurn) < 1e-3f) turnRate = targetTurn;
+
+        camera.beginStep();
+        camera.translate(velocity * dt);
+        camera.turn(turnRate * dt);
+        if (camera.position.y < settings.minHeight) {
+            camera.position.y = settings.minHeight;
+            velocity.y = std::max(velocity.y, 0.0f);
+        }
+        return moving();
+    }
+
+    bool moving() const { return dot(velocity, velocity) > 0.0f || turnRate != 0.0f; }
+    void stop() {
+        velocity = Vec3{0, 0, 0};
+        turnRate = 0.0f;
+    }
+
+private:
+    static float axis(const KeyState& keys, unsigned char positive, unsigned char negative) {
+        return (keys.held(positive) ? 1.0f : 0.0f) - (keys.held(negative) ? 1.0f : 0.0f);
+    }
+
+    Vec3 velocity{0, 0, 0};
+    float turnRate = 0.0f;
+};
+
+#endif
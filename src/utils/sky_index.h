@@ -0,0 +1,306 @@
+// ======================
+// Sky Spatial Index
+// ======================
+// Hierarchical cube-sphere tiling of the sky. Each of the six cube faces is
+// a quadtree of depth `depth`; leaf cells are numbered face-major, Morton order
+// inside a face, so every quadtree node covers one contiguous run of cells.
+// The catalog stores its stars grouped by leaf cell and sorted by magnitude
+// inside each cell, so "stars in view brighter than m" is a list of
+// (first, count) ranges into the star array - ready for glMultiDrawArrays.
+//
+// The tiling uses an arctangent warp so cells have roughly equal area, which
+// keeps cell occupancy even without the bookkeeping of a real HEALPix grid.
+
+#ifndef COSMIC_SKY_INDEX_H
+#define COSMIC_SKY_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "frustum.h"
+
+static const int kSkyIndexDepth = 5;     // 32 x 32 leaves per face, 6144 total
+
+namespace skycell {
+
+const float kQuarterPi = 0.78539816339f;
+
+inline uint32_t leafCount(int depth) { return 6u << (2 * depth); }
+
+inline uint32_t spreadBits(uint32_t v) {
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+// Direction -> face and warped face coordinates in [-1, 1]
+inline int faceOf(const float d[3], float& u, float& v) {
+    float ax = std::fabs(d[0]), ay = std::fabs(d[1]), az = std::fabs(d[2]);
+    int face;
+    float ma;
+    if (ax >= ay && ax >= az) { face = d[0] > 0 ? 0 : 1; ma = ax; u = d[1]; v = d[2]; }
+    else if (ay >= az)        { face = d[1] > 0 ? 2 : 3; ma = ay; u = d[2]; v = d[0]; }
+    else                      { face = d[2] > 0 ? 4 : 5; ma = az; u = d[0]; v = d[1]; }
+    u = std::atan(u / ma) / kQuarterPi;
+    v = std::atan(v / ma) / kQuarterPi;
+    return face;
+}
+
+// Warped face coordinates -> unit direction
+inline void directionOf(int face, float u, float v, float d[3]) {
+    float tu = std::tan(u * kQuarterPi), tv = std::tan(v * kQuarterPi);
+    float s = (face & 1) ? -1.0f : 1.0f;
+    switch (face >> 1) {
+        case 0:  d[0] = s;  d[1] = tu; d[2] = tv; break;
+        case 1:  d[0] = tv; d[1] = s;  d[2] = tu; break;
+        default: d[0] = tu; d[1] = tv; d[2] = s;  break;
+    }
+    float len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    d[0] /= len; d[1] /= len; d[2] /= len;
+}
+
+// Catalog (equatorial: x to RA 0h, z to the north pole) -> scene, where the
+// celestial pole points up (+Y)
+inline void toScene(const float d[3], float out[3]) {
+    out[0] = d[0];
+    out[1] = d[2];
+    out[2] = -d[1];
+}
+
+inline uint32_t leafOf(const float d[3], int depth) {
+    float u, v;
+    int face = faceOf(d, u, v);
+    int n = 1 << depth;
+    int ix = std::min(n - 1, std::max(0, (int)((u + 1.0f) * 0.5f * n)));
+    int iy = std::min(n - 1, std::max(0, (int)((v + 1.0f) * 0.5f * n)));
+    return ((uint32_t)face << (2 * depth)) | spreadBits(ix) | (spreadBits(iy) << 1);
+}
+
+} // namespace skycell
+
+// ----------------------
+// Build: group by leaf, magnitude order inside each leaf
+// ----------------------
+// Reorders `stars` in place and fills cellStart (leafCount + 1 entries).
+// Star needs `float dir[3]` (catalog frame) and `float mag`.
+template <typename Star>
+void buildSkyIndex(std::vector<Star>& stars, int depth, std::vector<uint32_t>& cellStart) {
+    uint32_t leaves = skycell::leafCount(depth);
+    std::vector<uint32_t> leafId(stars.size());
+    for (size_t i = 0; i < stars.size(); i++) leafId[i] = skycell::leafOf(stars[i].dir, depth);
+
+    std::vector<uint32_t> order(stars.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = (uint32_t)i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (leafId[a] != leafId[b]) return leafId[a] < leafId[b];
+        if (stars[a].mag != stars[b].mag) return stars[a].mag < stars[b].mag;
+        return a < b;
+    });
+
+    std::vector<Star> sorted(stars.size());
+    cellStart.assign(leaves + 1, 0);
+    for (size_t i = 0; i < order.size(); i++) {
+        sorted[i] = stars[order[i]];
+        cellStart[leafId[order[i]] + 1]++;
+    }
+    for (uint32_t c = 0; c < leaves; c++) cellStart[c + 1] += cellStart[c];
+    stars.swap(sorted);
+}
+
+// ----------------------
+// Query result
+// ----------------------
+struct SkyQuery {
+    std::vector<int32_t> first, count;   // star ranges, adjacent ranges merged
+    std::vector<uint32_t> leaves;        // leaf cells touching the frustum
+    size_t stars = 0;
+    int cellsVisited = 0;
+    float magLimit = 99.0f;              // limit actually applied (after the star budget)
+
+    void clear() {
+        first.clear(); count.clear(); leaves.clear();
+        stars = 0; cellsVisited = 0; magLimit = 99.0f;
+    }
+};
+
+// ----------------------
+// Runtime index over an already grouped star array
+// ----------------------
+template <typename Star>
+class SkyIndex {
+public:
+    // stars/cellStart usually point into the mapped catalog file.
+    void build(const Star* starArray, const uint32_t* cellStarts, int indexDepth) {
+        stars = starArray;
+        cellStart = cellStarts;
+        depth = indexDepth;
+        nodes.clear();
+        levelOffset.assign(depth + 2, 0);
+        for (int l = 0; l <= depth; l++) levelOffset[l + 1] = levelOffset[l] + (6u << (2 * l));
+        nodes.resize(levelOffset[depth + 1]);
+
+        for (int l = 0; l <= depth; l++) {
+            int n = 1 << l;
+            for (uint32_t i = 0; i < (6u << (2 * l)); i++) {
+                Node& node = nodes[levelOffset[l] + i];
+                int face = (int)(i >> (2 * l));
+                uint32_t morton = i & ((1u << (2 * l)) - 1);
+                int ix = 0, iy = 0;
+                for (int b = 0; b < l; b++) {
+                    ix |= ((morton >> (2 * b)) & 1) << b;
+                    iy |= ((morton >> (2 * b + 1)) & 1) << b;
+                }
+                float u0 = -1.0f + 2.0f * ix / n, u1 = -1.0f + 2.0f * (ix + 1) / n;
+                float v0 = -1.0f + 2.0f * iy / n, v1 = -1.0f + 2.0f * (iy + 1) / n;
+                float axis[3];
+                skycell::directionOf(face, 0.5f * (u0 + u1), 0.5f * (v0 + v1), axis);
+
+                // Cap radius: farthest corner (the patch is a convex spherical quad)
+                float minDot = 1.0f;
+                float us[2] = {u0, u1}, vs[2] = {v0, v1};
+                for (int a = 0; a < 2; a++)
+                    for (int b = 0; b < 2; b++) {
+                        float c[3];
+                        skycell::directionOf(face, us[a], vs[b], c);
+                        minDot = std::min(minDot, c[0] * axis[0] + c[1] * axis[1] + c[2] * axis[2]);
+                    }
+                skycell::toScene(axis, node.axis);
+                node.cosRadius = minDot;
+                node.sinRadius = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+
+                uint32_t span = 1u << (2 * (depth - l));
+                node.firstLeaf = i * span;
+                node.lastLeaf = node.firstLeaf + span;   // exclusive
+                node.brightest = 99.0f;
+                for (uint32_t leaf = node.firstLeaf; leaf < node.lastLeaf; leaf++)
+                    if (cellStart[leaf] < cellStart[leaf + 1])
+                        node.brightest = std::min(node.brightest, stars[cellStart[leaf]].mag);
+            }
+        }
+    }
+
+    bool ready() const { return stars != nullptr; }
+    size_t cellCount() const { return depth >= 0 ? skycell::leafCount(depth) : 0; }
+
+    // Ranges of stars with mag < magLimit whose cells touch the frustum.
+    // Stars sit on a sphere of radius skyRadius around the origin. With
+    // maxStars > 0 the limit is lowered (per view, over the visible cells
+    // only) until at most maxStars stars are returned; out.magLimit holds
+    // the limit that was applied.
+    void query(const Frustum& frustum, float skyRadius, float magLimit, SkyQuery& out,
+               size_t maxStars = 0) const {
+        float previousLimit = out.magLimit;   // frame-to-frame coherence for the budget fit
+        out.clear();
+        if (!stars) return;
+        for (uint32_t face = 0; face < 6; face++)
+            visit(0, face, frustum, skyRadius, magLimit, false, out);
+
+        size_t total = maxStars > 0 ? countBrighter(out.leaves, magLimit) : 0;
+        if (total > maxStars) magLimit = fitBudget(out.leaves, magLimit, total, maxStars, previousLimit);
+        out.magLimit = magLimit;
+        for (uint32_t leaf : out.leaves) emitLeaf(leaf, magLimit, out);
+    }
+
+private:
+    struct Node {
+        float axis[3];            // scene frame
+        float cosRadius, sinRadius;
+        uint32_t firstLeaf, lastLeaf;
+        float brightest;          // smallest magnitude in the subtree
+    };
+
+    void visit(int level, uint32_t i, const Frustum& frustum, float radius, float magLimit,
+               bool inside, SkyQuery& out) const {
+        const Node& node = nodes[levelOffset[level] + i];
+        if (node.brightest >= magLimit) return;
+        out.cellsVisited++;
+
+        if (!inside) {
+            // Bounding sphere of the spherical cap
+            float c = radius * node.cosRadius;
+            FrustumTest t = frustum.testSphere(node.axis[0] * c, node.axis[1] * c,
+                                               node.axis[2] * c, radius * node.sinRadius);
+            if (t == FRUSTUM_OUTSIDE) return;
+            inside = (t == FRUSTUM_INSIDE);
+        }
+
+        if (level == depth) {
+            out.leaves.push_back(node.firstLeaf);
+            return;
+        }
+        for (uint32_t child = 0; child < 4; child++)
+            visit(level + 1, i * 4 + child, frustum, radius, magLimit, inside, out);
+    }
+
+    // Stars in the leaf brighter than magLimit (leaves are magnitude sorted)
+    uint32_t starsInLeaf(uint32_t leaf, float magLimit) const {
+        const Star* begin = stars + cellStart[leaf];
+        const Star* end = stars + cellStart[leaf + 1];
+        const Star* cut = std::lower_bound(begin, end, magLimit,
+            [](const Star& s, float m) { return s.mag < m; });
+        return (uint32_t)(cut - begin);
+    }
+
+    size_t countBrighter(const std::vector<uint32_t>& leaves, float magLimit) const {
+        size_t n = 0;
+        for (uint32_t leaf : leaves) n += starsInLeaf(leaf, magLimit);
+        return n;
+    }
+
+    // Largest limit whose star count fits the budget. Star counts grow roughly
+    // as 10^(0.5 m), so the search interpolates in log(count) and needs only a
+    // few passes over the visible leaves (the first probe is last frame's
+    // limit); the bracket keeps it safe otherwise.
+    float fitBudget(const std::vector<uint32_t>& leaves, float hiMag, size_t hiCount,
+                    size_t maxStars, float guess) const {
+        // Bracket by the magnitudes actually present in the visible cells
+        float loMag = hiMag, faintest = -99.0f;
+        for (uint32_t leaf : leaves) {
+            if (cellStart[leaf] == cellStart[leaf + 1]) continue;
+            loMag = std::min(loMag, stars[cellStart[leaf]].mag);
+            faintest = std::max(faintest, stars[cellStart[leaf + 1] - 1].mag);
+        }
+        hiMag = std::min(hiMag, faintest + 0.001f);
+        size_t loCount = 0;     // strictly brighter than the brightest star
+        const float target = std::log((float)maxStars);
+        for (int i = 0; i < 16 && hiMag - loMag > 0.02f; i++) {
+            float lo = std::log((float)std::max<size_t>(loCount, 1));
+            float hi = std::log((float)hiCount);
+            float t = (target - lo) / std::max(hi - lo, 1e-6f);
+            t = std::min(0.9f, std::max(0.1f, t));
+            float mag = loMag + (hiMag - loMag) * t;
+            if (i == 0 && guess > loMag && guess < hiMag) mag = guess;
+            size_t n = countBrighter(leaves, mag);
+            if (n > maxStars) { hiMag = mag; hiCount = n; }
+            else { loMag = mag; loCount = n; }
+            if (n <= maxStars && n * 50 >= maxStars * 49) break;   // within 2%
+        }
+        return loMag;
+    }
+
+    void emitLeaf(uint32_t leaf, float magLimit, SkyQuery& out) const {
+        int32_t first = (int32_t)cellStart[leaf];
+        int32_t n = (int32_t)starsInLeaf(leaf, magLimit);
+        if (n == 0) return;
+
+        if (!out.first.empty() && out.first.back() + out.count.back() == first) {
+            out.count.back() += n;
+        } else {
+            out.first.push_back(first);
+            out.count.push_back(n);
+        }
+        out.stars += n;
+    }
+
+    const Star* stars = nullptr;
+    const uint32_t* cellStart = nullptr;
+    int depth = -1;
+    std::vector<uint32_t> levelOffset;
+    std::vector<Node> nodes;
+};
+
+#endif
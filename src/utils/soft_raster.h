@@ -0,0 +1,507 @@
+// ======================
+// Software Triangle Rasteriser
+// ======================
+// Draws the lit telescope into a CpuFramebuffer without a GPU (--soft-telescope).
+// llvmpipe's fixed-function path is slow for drawTelescope()'s per-face
+// glBegin/glEnd submission; this one renders the same mesh in a few stages:
+//
+//   1. Transform - the welded mesh is stored as structure-of-arrays, so SSE
+//      transforms four vertices per step into eye and clip space.
+//   2. Lighting  - per-vertex fixed-function lighting with the same lights and
+//      material rules as initGL(): positional lights in eye space, infinite
+//      viewer, GL_COLOR_MATERIAL on ambient and diffuse, unnormalised
+//      normals (GL_NORMALIZE is off), then a clamp (Gouraud shading).
+//   3. Setup     - triangles are clipped to the near plane, snapped to 1/16
+//      pixel and binned into 64x64 tiles in submission order.
+//   4. Raster    - worker threads take tiles from an atomic counter. Each tile
+//      walks its bin with integer edge functions (top-left fill rule), a
+//      GL_LEQUAL depth test and perspective-correct colour.
+//
+// Tiles never share pixels, so the workers need no locks.
+
+#ifndef COSMIC_SOFT_RASTER_H
+#define COSMIC_SOFT_RASTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "cpu_framebuffer.h"
+#include "trace_recorder.h"
+
+// Fixed-function material after GL_COLOR_MATERIAL (ambient = diffuse = colour)
+struct SoftMaterial {
+    float ambient[3], diffuse[3], specular[3], emission[3];
+    float shininess;
+};
+
+// Positional light in eye space
+struct SoftLight {
+    float position[3];
+    float ambient[3], diffuse[3], specular[3];
+};
+
+// ----------------------
+// Welded mesh
+// ----------------------
+// Vertices are unique (position, normal, material) triples, so corners
+// shared by neighbouring faces are transformed and lit once.
+struct SoftMesh {
+    std::vector<float> x, y, z;
+    std::vector<float> nx, ny, nz;
+    std::vector<uint16_t> material;   // per vertex
+    std::vector<uint32_t> indices;    // three per triangle
+
+    size_t vertexCount() const { return x.size(); }
+    size_t triangleCount() const { return indices.size() / 3; }
+};
+
+class SoftMeshBuilder {
+public:
+    explicit SoftMeshBuilder(SoftMesh& mesh) : mesh(mesh) {}
+
+    uint32_t vertex(const float p[3], const float n[3], uint16_t material) {
+        Key key;
+        std::memcpy(key.v, p, 3 * sizeof(float));
+        std::memcpy(key.v + 3, n, 3 * sizeof(float));
+        key.material = material;
+        std::unordered_map<Key, uint32_t, KeyHash>::iterator it = welded.find(key);
+        if (it != welded.end()) return it->second;
+
+        uint32_t index = (uint32_t)mesh.x.size();
+        mesh.x.push_back(p[0]); mesh.y.push_back(p[1]); mesh.z.push_back(p[2]);
+        mesh.nx.push_back(n[0]); mesh.ny.push_back(n[1]); mesh.nz.push_back(n[2]);
+        mesh.material.push_back(material);
+        welded[key] = index;
+        return index;
+    }
+
+    void triangle(uint32_t a, uint32_t b, uint32_t c) {
+        mesh.indices.push_back(a);
+        mesh.indices.push_back(b);
+        mesh.indices.push_back(c);
+    }
+
+private:
+    struct Key {
+        float v[6];
+        uint16_t material;
+        bool operator==(const Key& o) const {
+            return std::memcmp(v, o.v, sizeof(v)) == 0 && material == o.material;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint32_t bits[6];
+            std::memcpy(bits, k.v, sizeof(bits));
+            size_t h = k.material;
+            for (int i = 0; i < 6; i++) h = h * 0x9E3779B97F4A7C15ull + bits[i];
+            return h ^ (h >> 29);
+        }
+    };
+
+    SoftMesh& mesh;
+    std::unordered_map<Key, uint32_t, KeyHash> welded;
+};
+
+struct SoftRasterStats {
+    size_t vertices = 0, triangles = 0;
+    size_t culled = 0;        // wholly outside the frustum or degenerate
+    size_t nearClipped = 0;   // crossed the near plane
+    size_t binEntries = 0;    // triangle-in-tile references
+    size_t fragments = 0;     // pixels that passed the depth test
+    int threads = 0;
+    double transformMs = 0, setupMs = 0, rasterMs = 0;
+};
+
+// ----------------------
+// Rasteriser
+// ----------------------
+class SoftRasterizer {
+public:
+    static const int kTileSize = 64;
+    static const int kSubpixelBits = 4;
+
+    SoftRasterizer() {
+        unsigned n = std::thread::hardware_concurrency();
+        threadCount = n > 0 ? (int)n : 1;
+    }
+
+    void setThreads(int n) { threadCount = std::max(1, n); }
+    int threads() const { return threadCount; }
+
+    void setLights(const SoftLight* l, int count, const float ambient[3]) {
+        lights.assign(l, l + count);
+        std::copy(ambient, ambient + 3, globalAmbient);
+    }
+
+    void clearDepth() { std::fill(depth.begin(), depth.end(), 1.0f); }
+
+    // Depth persists between draws until clearDepth() or a size change
+    void draw(const SoftMesh& mesh, const SoftMaterial* materials, size_t materialCount,
+              const float modelView[16], const float projection[16], CpuFramebuffer& fb) {
+        width = fb.getWidth();
+        height = fb.getHeight();
+        if ((int)depth.size() != width * height) depth.assign((size_t)width * height, 1.0f);
+
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point t0 = Clock::now();
+        frameStats = SoftRasterStats();
+        frameStats.vertices = mesh.vertexCount();
+        frameStats.triangles = mesh.triangleCount();
+
+        transform(mesh, modelView, projection);
+        light(mesh, materials, materialCount);
+        Clock::time_point t1 = Clock::now();
+
+        setup(mesh);
+        Clock::time_point t2 = Clock::now();
+
+        rasterize(fb);
+        Clock::time_point t3 = Clock::now();
+
+        traceRecorder().complete("soft transform + light", "soft_raster", t0, t1);
+        traceRecorder().complete("soft setup", "soft_raster", t1, t2);
+        traceRecorder().complete("soft raster", "soft_raster", t2, t3);
+
+        frameStats.transformMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        frameStats.setupMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        frameStats.rasterMs = std::chrono::duration<double, std::milli>(t3 - t2).count();
+    }
+
+    const SoftRasterStats& stats() const { return frameStats; }
+
+private:
+    // ----------------------
+    // 1. Transform
+    // ----------------------
+    void transform(const SoftMesh& mesh, const float mv[16], const float proj[16]) {
+        size_t n = mesh.vertexCount();
+        ex.resize(n); ey.resize(n); ez.resize(n);
+        cx.resize(n); cy.resize(n); cz.resize(n); cw.resize(n);
+        enx.resize(n); eny.resize(n); enz.resize(n);
+
+        // Normal matrix: inverse transpose of the upper 3x3 (cofactors / det)
+        const float a = mv[0], b = mv[4], c = mv[8], d = mv[1], e = mv[5], f = mv[9],
+                    g = mv[2], h = mv[6], i = mv[10];
+        float det = a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+        float inv = det != 0.0f ? 1.0f / det : 0.0f;
+        // Row-major rows of inverse(M)^T
+        const float nm[9] = {(e * i - f * h) * inv, -(d * i - f * g) * inv, (d * h - e * g) * inv,
+                             -(b * i - c * h) * inv, (a * i - c * g) * inv, -(a * h - b * g) * inv,
+                             (b * f - c * e) * inv, -(a * f - c * d) * inv, (a * e - b * d) * inv};
+
+        size_t k = 0;
+#ifdef COSMIC_CPU_SSE2
+        for (; k + 4 <= n; k += 4) {
+            __m128 x = _mm_loadu_ps(&mesh.x[k]), y = _mm_loadu_ps(&mesh.y[k]), z = _mm_loadu_ps(&mesh.z[k]);
+            __m128 px = affine(mv, 0, x, y, z), py = affine(mv, 1, x, y, z), pz = affine(mv, 2, x, y, z);
+            _mm_storeu_ps(&ex[k], px);
+            _mm_storeu_ps(&ey[k], py);
+            _mm_storeu_ps(&ez[k], pz);
+            // The projection is applied to the eye position (w = 1 after gluLookAt * model)
+            _mm_storeu_ps(&cx[k], affine(proj, 0, px, py, pz));
+            _mm_storeu_ps(&cy[k], affine(proj, 1, px, py, pz));
+            _mm_storeu_ps(&cz[k], affine(proj, 2, px, py, pz));
+            _mm_storeu_ps(&cw[k], affine(proj, 3, px, py, pz));
+
+            __m128 nx = _mm_loadu_ps(&mesh.nx[k]), ny = _mm_loadu_ps(&mesh.ny[k]), nz = _mm_loadu_ps(&mesh.nz[k]);
+            _mm_storeu_ps(&enx[k], linear3(nm, 0, nx, ny, nz));
+            _mm_storeu_ps(&eny[k], linear3(nm, 1, nx, ny, nz));
+            _mm_storeu_ps(&enz[k], linear3(nm, 2, nx, ny, nz));
+        }
+#endif
+        for (; k < n; k++) {
+            float x = mesh.x[k], y = mesh.y[k], z = mesh.z[k];
+            float px = mv[0] * x + mv[4] * y + mv[8] * z + mv[12];
+            float py = mv[1] * x + mv[5] * y + mv[9] * z + mv[13];
+            float pz = mv[2] * x + mv[6] * y + mv[10] * z + mv[14];
+            ex[k] = px; ey[k] = py; ez[k] = pz;
+            cx[k] = proj[0] * px + proj[4] * py + proj[8] * pz + proj[12];
+            cy[k] = proj[1] * px + proj[5] * py + proj[9] * pz + proj[13];
+            cz[k] = proj[2] * px + proj[6] * py + proj[10] * pz + proj[14];
+            cw[k] = proj[3] * px + proj[7] * py + proj[11] * pz + proj[15];
+            float nx = mesh.nx[k], ny = mesh.ny[k], nz = mesh.nz[k];
+            enx[k] = nm[0] * nx + nm[1] * ny + nm[2] * nz;
+            eny[k] = nm[3] * nx + nm[4] * ny + nm[5] * nz;
+            enz[k] = nm[6] * nx + nm[7] * ny + nm[8] * nz;
+        }
+    }
+
+#ifdef COSMIC_CPU_SSE2
+    // Row r of a column-major 4x4 applied to (x, y, z, 1), four vertices at once
+    static __m128 affine(const float m[16], int r, __m128 x, __m128 y, __m128 z) {
+        __m128 out = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[r]), x), _mm_mul_ps(_mm_set1_ps(m[4 + r]), y));
+        return _mm_add_ps(_mm_add_ps(out, _mm_mul_ps(_mm_set1_ps(m[8 + r]), z)), _mm_set1_ps(m[12 + r]));
+    }
+
+    // Row r of a row-major 3x3
+    static __m128 linear3(const float m[9], int r, __m128 x, __m128 y, __m128 z) {
+        __m128 out = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[3 * r]), x), _mm_mul_ps(_mm_set1_ps(m[3 * r + 1]), y));
+        return _mm_add_ps(out, _mm_mul_ps(_mm_set1_ps(m[3 * r + 2]), z));
+    }
+#endif
+
+    // ----------------------
+    // 2. Lighting (glLightModel defaults: global ambient, infinite viewer, one-sided)
+    // ----------------------
+    void light(const SoftMesh& mesh, const SoftMaterial* materials, size_t materialCount) {
+        size_t n = mesh.vertexCount();
+        cr.resize(n); cg.resize(n); cb.resize(n);
+        static const SoftMaterial fallback = {{1, 1, 1}, {1, 1, 1}, {0, 0, 0}, {0.3f, 0.3f, 0.3f}, 0};
+        for (size_t k = 0; k < n; k++) {
+            const SoftMaterial& m = mesh.material[k] < materialCount ? materials[mesh.material[k]] : fallback;
+            float c[3];
+            for (int j = 0; j < 3; j++) c[j] = m.emission[j] + globalAmbient[j] * m.ambient[j];
+            float N[3] = {enx[k], eny[k], enz[k]};
+            for (const SoftLight& l : lights) {
+                float L[3] = {l.position[0] - ex[k], l.position[1] - ey[k], l.position[2] - ez[k]};
+                float len = std::sqrt(L[0] * L[0] + L[1] * L[1] + L[2] * L[2]);
+                if (len > 0) { L[0] /= len; L[1] /= len; L[2] /= len; }
+                float ndotl = N[0] * L[0] + N[1] * L[1] + N[2] * L[2];
+                float diffuse = std::max(0.0f, ndotl);
+                float specular = 0;
+                if (ndotl > 0) {
+                    float H[3] = {L[0], L[1], L[2] + 1.0f};   // viewer at (0, 0, +inf)
+                    float hl = std::sqrt(H[0] * H[0] + H[1] * H[1] + H[2] * H[2]);
+                    float ndoth = hl > 0 ? (N[0] * H[0] + N[1] * H[1] + N[2] * H[2]) / hl : 0;
+                    specular = std::pow(std::max(0.0f, ndoth), m.shininess);
+                }
+                for (int j = 0; j < 3; j++)
+                    c[j] += l.ambient[j] * m.ambient[j] + diffuse * l.diffuse[j] * m.diffuse[j] +
+                            specular * l.specular[j] * m.specular[j];
+            }
+            cr[k] = std::min(1.0f, std::max(0.0f, c[0])) * 255.0f;
+            cg[k] = std::min(1.0f, std::max(0.0f, c[1])) * 255.0f;
+            cb[k] = std::min(1.0f, std::max(0.0f, c[2])) * 255.0f;
+        }
+    }
+
+    // ----------------------
+    // 3. Setup and binning
+    // ----------------------
+    struct ClipVertex {
+        float x, y, z, w, r, g, b;
+    };
+
+    struct Triangle {
+        int32_t X[3], Y[3];         // 1/16 pixel, y down
+        float z[3];                 // window depth 0..1
+        float invW[3];
+        float r[3], g[3], b[3];     // colour / w
+        int64_t area;               // twice the signed area, > 0
+        int minX, minY, maxX, maxY; // pixel bounds, inclusive
+    };
+
+    void setup(const SoftMesh& mesh) {
+        tilesX = (width + kTileSize - 1) / kTileSize;
+        tilesY = (height + kTileSize - 1) / kTileSize;
+        bins.resize((size_t)tilesX * tilesY);
+        for (std::vector<uint32_t>& bin : bins) bin.clear();
+        triangles.clear();
+
+        for (size_t t = 0; t < mesh.triangleCount(); t++) {
+            ClipVertex v[3];
+            unsigned outside = 0x3F;   // planes every vertex is outside of
+            for (int j = 0; j < 3; j++) {
+                uint32_t k = mesh.indices[3 * t + j];
+                v[j] = ClipVertex{cx[k], cy[k], cz[k], cw[k], cr[k], cg[k], cb[k]};
+                unsigned codes = (v[j].x < -v[j].w) | (v[j].x > v[j].w) << 1 | (v[j].y < -v[j].w) << 2 |
+                                 (v[j].y > v[j].w) << 3 | (v[j].z < -v[j].w) << 4 | (v[j].z > v[j].w) << 5;
+                outside &= codes;
+            }
+            if (outside) {
+                frameStats.culled++;
+                continue;
+            }
+
+            // Near plane: clip the triangle into a polygon of up to four vertices
+            float d[3];
+            bool crosses = false;
+            for (int j = 0; j < 3; j++) {
+                d[j] = v[j].z + v[j].w;
+                crosses |= d[j] < 0;
+            }
+            if (!crosses) {
+                addTriangle(v[0], v[1], v[2]);
+                continue;
+            }
+            frameStats.nearClipped++;
+            ClipVertex poly[4];
+            int count = 0;
+            for (int j = 0; j < 3; j++) {
+                int k = (j + 1) % 3;
+                if (d[j] >= 0) poly[count++] = v[j];
+                if ((d[j] >= 0) != (d[k] >= 0)) poly[count++] = lerp(v[j], v[k], d[j] / (d[j] - d[k]));
+            }
+            for (int j = 1; j + 1 < count; j++) addTriangle(poly[0], poly[j], poly[j + 1]);
+        }
+    }
+
+    static ClipVertex lerp(const ClipVertex& a, const ClipVertex& b, float t) {
+        return ClipVertex{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t,
+                          a.w + (b.w - a.w) * t, a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t,
+                          a.b + (b.b - a.b) * t};
+    }
+
+    void addTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c) {
+        const ClipVertex* v[3] = {&a, &b, &c};
+        Triangle tri;
+        const float scale = (float)(1 << kSubpixelBits);
+        const float limit = (float)(1 << 26);   // keeps edge products in 64 bits
+        float fx[3], fy[3];
+        for (int j = 0; j < 3; j++) {
+            float iw = 1.0f / v[j]->w;
+            fx[j] = std::min(std::max((v[j]->x * iw * 0.5f + 0.5f) * width * scale, -limit), limit);
+            fy[j] = std::min(std::max((0.5f - v[j]->y * iw * 0.5f) * height * scale, -limit), limit);
+            tri.X[j] = (int32_t)std::lround(fx[j]);
+            tri.Y[j] = (int32_t)std::lround(fy[j]);
+            tri.z[j] = v[j]->z * iw * 0.5f + 0.5f;
+            tri.invW[j] = iw;
+            tri.r[j] = v[j]->r * iw;
+            tri.g[j] = v[j]->g * iw;
+            tri.b[j] = v[j]->b * iw;
+        }
+        int64_t area = (int64_t)(tri.X[1] - tri.X[0]) * (tri.Y[2] - tri.Y[0]) -
+                       (int64_t)(tri.Y[1] - tri.Y[0]) * (tri.X[2] - tri.X[0]);
+        if (area == 0) {
+            frameStats.culled++;
+            return;
+        }
+        if (area < 0) {
+            // No face culling: flip to one winding so inside is always >= 0
+            std::swap(tri.X[1], tri.X[2]); std::swap(tri.Y[1], tri.Y[2]);
+            std::swap(tri.z[1], tri.z[2]); std::swap(tri.invW[1], tri.invW[2]);
+            std::swap(tri.r[1], tri.r[2]); std::swap(tri.g[1], tri.g[2]); std::swap(tri.b[1], tri.b[2]);
+            area = -area;
+        }
+        tri.area = area;
+
+        // Pixel centres at (p + 0.5) * 16 inside the subpixel bounds
+        const int half = 1 << (kSubpixelBits - 1);
+        int x0 = std::min(tri.X[0], std::min(tri.X[1], tri.X[2])), x1 = std::max(tri.X[0], std::max(tri.X[1], tri.X[2]));
+        int y0 = std::min(tri.Y[0], std::min(tri.Y[1], tri.Y[2])), y1 = std::max(tri.Y[0], std::max(tri.Y[1], tri.Y[2]));
+        tri.minX = std::max(0, (x0 - half + (1 << kSubpixelBits) - 1) >> kSubpixelBits);
+        tri.minY = std::max(0, (y0 - half + (1 << kSubpixelBits) - 1) >> kSubpixelBits);
+        tri.maxX = std::min(width - 1, (x1 - half) >> kSubpixelBits);
+        tri.maxY = std::min(height - 1, (y1 - half) >> kSubpixelBits);
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+            frameStats.culled++;
+            return;
+        }
+
+        uint32_t index = (uint32_t)triangles.size();
+        triangles.push_back(tri);
+        for (int ty = tri.minY / kTileSize; ty <= tri.maxY / kTileSize; ty++)
+            for (int tx = tri.minX / kTileSize; tx <= tri.maxX / kTileSize; tx++) {
+                bins[(size_t)ty * tilesX + tx].push_back(index);
+                frameStats.binEntries++;
+            }
+    }
+
+    // ----------------------
+    // 4. Parallel tile rasterisation
+    // ----------------------
+    void rasterize(CpuFramebuffer& fb) {
+        std::atomic<int> nextTile(0);
+        std::atomic<size_t> fragments(0);
+        uint32_t* pixels = fb.data();
+        int tileCount = tilesX * tilesY;
+        auto worker = [&]() {
+            TraceScope trace("raster tiles", "soft_raster");
+            size_t written = 0;
+            for (int tile; (tile = nextTile.fetch_add(1)) < tileCount; )
+                written += rasterTile(tile, pixels);
+            fragments += written;
+        };
+        auto pooled = [&]() {
+            traceRecorder().nameThread("soft raster worker");
+            worker();
+        };
+
+        int workers = std::min(threadCount, std::max(1, tileCount));
+        std::vector<std::thread> pool;
+        for (int i = 1; i < workers; i++) pool.push_back(std::thread(pooled));
+        worker();
+        for (std::thread& t : pool) t.join();
+        frameStats.threads = workers;
+        frameStats.fragments = fragments;
+    }
+
+    size_t rasterTile(int tile, uint32_t* pixels) {
+        const std::vector<uint32_t>& bin = bins[tile];
+        if (bin.empty()) return 0;
+        int tileX = (tile % tilesX) * kTileSize, tileY = (tile / tilesX) * kTileSize;
+        int tileX1 = std::min(tileX + kTileSize, width) - 1, tileY1 = std::min(tileY + kTileSize, height) - 1;
+        const int one = 1 << kSubpixelBits, half = one >> 1;
+        size_t written = 0;
+
+        for (uint32_t index : bin) {
+            const Triangle& t = triangles[index];
+            int x0 = std::max(t.minX, tileX), x1 = std::min(t.maxX, tileX1);
+            int y0 = std::max(t.minY, tileY), y1 = std::min(t.maxY, tileY1);
+            if (x0 > x1 || y0 > y1) continue;
+
+            // Edge i is opposite vertex i, so it weights that vertex
+            int64_t stepX[3], stepY[3], row[3];
+            int64_t px = (int64_t)x0 * one + half, py = (int64_t)y0 * one + half;
+            for (int i = 0; i < 3; i++) {
+                int a = (i + 1) % 3, b = (i + 2) % 3;
+                int64_t dx = t.X[b] - t.X[a], dy = t.Y[b] - t.Y[a];
+                // E(p) = (b - a) x (p - a); positive inside for the flipped winding
+                row[i] = dx * (py - t.Y[a]) - dy * (px - t.X[a]);
+                stepX[i] = -dy * one;
+                stepY[i] = dx * one;
+                // Top-left rule: pixels exactly on a right or bottom edge belong to the neighbour
+                bool topLeft = (dy < 0) || (dy == 0 && dx > 0);
+                if (!topLeft) row[i] -= 1;
+            }
+            float invArea = 1.0f / (float)t.area;
+
+            for (int y = y0; y <= y1; y++) {
+                int64_t e0 = row[0], e1 = row[1], e2 = row[2];
+                float* depthRow = &depth[(size_t)y * width];
+                uint32_t* colorRow = pixels + (size_t)y * width;
+                for (int x = x0; x <= x1; x++) {
+                    if ((e0 | e1 | e2) >= 0) {
+                        float b0 = (float)e0 * invArea, b1 = (float)e1 * invArea;
+                        float b2 = 1.0f - b0 - b1;
+                        float z = b0 * t.z[0] + b1 * t.z[1] + b2 * t.z[2];
+                        if (z <= depthRow[x]) {
+                            depthRow[x] = z;
+                            float w = 1.0f / (b0 * t.invW[0] + b1 * t.invW[1] + b2 * t.invW[2]);
+                            int r = (int)((b0 * t.r[0] + b1 * t.r[1] + b2 * t.r[2]) * w + 0.5f);
+                            int g = (int)((b0 * t.g[0] + b1 * t.g[1] + b2 * t.g[2]) * w + 0.5f);
+                            int b = (int)((b0 * t.b[0] + b1 * t.b[1] + b2 * t.b[2]) * w + 0.5f);
+                            colorRow[x] = packRGBA((uint8_t)std::min(255, std::max(0, r)),
+                                                   (uint8_t)std::min(255, std::max(0, g)),
+                                                   (uint8_t)std::min(255, std::max(0, b)), 255);
+                            written++;
+                        }
+                    }
+                    e0 += stepX[0]; e1 += stepX[1]; e2 += stepX[2];
+                }
+                row[0] += stepY[0]; row[1] += stepY[1]; row[2] += stepY[2];
+            }
+        }
+        return written;
+    }
+
+    int threadCount = 1;
+    int width = 0, height = 0, tilesX = 0, tilesY = 0;
+    std::vector<SoftLight> lights;
+    float globalAmbient[3] = {0.2f, 0.2f, 0.2f};
+
+    std::vector<float> ex, ey, ez, cx, cy, cz, cw, enx, eny, enz, cr, cg, cb;
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<uint32_t>> bins;
+    std::vector<float> depth;
+    SoftRasterStats frameStats;
+};
+
+#endif
@@ -0,0 +1,387 @@
+// ======================
+// Star Catalog
+// ======================
+// Real stars from an HYG / Hipparcos-style CSV. The CSV is converted once
+// (--import-catalog) into a flat binary file that the app memory-maps at
+// startup: no parsing, no per-star allocation, the records are used in place.
+//
+// File layout (little-endian):
+//   CatalogHeader
+//   CatalogStar[starCount]      grouped by sky index cell, brightest first in each
+//   uint32_t[cellCount + 1]     first star of each cell (see sky_index.h)
+//   CatalogHipEntry[hipCount]   sorted by Hipparcos number, for id lookups
+
+#ifndef COSMIC_STAR_CATALOG_H
+#define COSMIC_STAR_CATALOG_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sky_index.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ----------------------
+// On-disk records
+// ----------------------
+static const char kCatalogMagic[8] = {'C', 'O', 'S', 'M', 'C', 'A', 'T', '1'};
+static const uint32_t kCatalogVersion = 2;
+static const uint32_t kCatalogByteOrder = 0x01020304;
+static const double kCatalogPi = 3.14159265358979323846;
+
+struct CatalogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t starCount;
+    uint32_t hipCount;
+    uint32_t starOffset;     // byte offsets from the start of the file
+    uint32_t hipOffset;
+    uint32_t indexDepth;     // sky index quadtree depth
+    uint32_t cellOffset;     // cellCount + 1 uint32 cell starts
+};
+
+struct CatalogStar {
+    float dir[3];        // unit vector, equatorial J2000: x to RA 0h, z to the north pole
+    float mag;           // apparent visual magnitude
+    float ci;            // B-V colour index
+    uint32_t hip;        // Hipparcos number, 0 if none
+};
+
+struct CatalogHipEntry {
+    uint32_t hip;
+    uint32_t index;      // into the star array
+};
+
+// ----------------------
+// Read-only memory mapping
+// ----------------------
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        GetFileSizeEx(file, &sz);
+        length = (size_t)sz.QuadPart;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) { close(); return false; }
+        bytes = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!bytes) { close(); return false; }
+#else
+        fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { close(); return false; }
+        length = (size_t)st.st_size;
+        void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) { close(); return false; }
+        bytes = (const uint8_t*)p;
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) munmap((void*)bytes, length);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// ----------------------
+// Loaded catalog (views into the mapping)
+// ----------------------
+class StarCatalog {
+public:
+    bool load(const char* path) {
+        stars = nullptr;
+        hipIndex = nullptr;
+        cellStart = nullptr;
+        count = hipCount = 0;
+        if (!file.open(path)) return false;
+
+        const CatalogHeader* h = (const CatalogHeader*)file.data();
+        if (file.size() < sizeof(CatalogHeader) ||
+            std::memcmp(h->magic, kCatalogMagic, sizeof(kCatalogMagic)) != 0 ||
+            h->version != kCatalogVersion || h->byteOrder != kCatalogByteOrder ||
+            h->starOffset + (size_t)h->starCount * sizeof(CatalogStar) > file.size() ||
+            h->hipOffset + (size_t)h->hipCount * sizeof(CatalogHipEntry) > file.size() ||
+            h->indexDepth > 12 ||
+            h->cellOffset + (skycell::leafCount(h->indexDepth) + 1) * sizeof(uint32_t) > file.size() ||
+            !validCells((const uint32_t*)(file.data() + h->cellOffset), skycell::leafCount(h->indexDepth),
+                        h->starCount) ||
+            !validHips((const CatalogHipEntry*)(file.data() + h->hipOffset), h->hipCount, h->starCount)) {
+            std::cerr << "ERR: " << path << " is not a valid star catalog" << std::endl;
+            file.close();
+            return false;
+        }
+
+        stars = (const CatalogStar*)(file.data() + h->starOffset);
+        hipIndex = (const CatalogHipEntry*)(file.data() + h->hipOffset);
+        cellStart = (const uint32_t*)(file.data() + h->cellOffset);
+        count = h->starCount;
+        hipCount = h->hipCount;
+        depth = (int)h->indexDepth;
+        index.build(stars, cellStart, depth);
+        return true;
+    }
+
+    bool loaded() const { return stars != nullptr; }
+    size_t size() const { return count; }
+    const CatalogStar& operator[](size_t i) const { return stars[i]; }
+    const CatalogStar* begin() const { return stars; }
+    const CatalogStar* end() const { return stars + count; }
+    const SkyIndex<CatalogStar>& skyIndex() const { return index; }
+
+    // Index of the star with this Hipparcos number, or -1
+    long findHip(uint32_t hip) const {
+        const CatalogHipEntry* last = hipIndex + hipCount;
+        const CatalogHipEntry* it = std::lower_bound(hipIndex, last, hip,
+            [](const CatalogHipEntry& e, uint32_t h) { return e.hip < h; });
+        return (it != last && it->hip == hip && it->index < count) ? (long)it->index : -1;
+    }
+
+private:
+    // The sky index reads stars[cellStart[leaf]] unchecked: the table must
+    // start at 0, never decrease and end at the star count
+    static bool validCells(const uint32_t* cellStart, uint32_t leaves, uint32_t starCount) {
+        if (cellStart[0] != 0 || cellStart[leaves] != starCount) return false;
+        for (uint32_t c = 0; c < leaves; c++)
+            if (cellStart[c + 1] < cellStart[c]) return false;
+        return true;
+    }
+
+    // findHip() binary-searches the HIP table and callers index stars[] with
+    // the result: it must be sorted by hip and point inside the star array
+    static bool validHips(const CatalogHipEntry* hips, uint32_t hipCount, uint32_t starCount) {
+        for (uint32_t i = 0; i < hipCount; i++)
+            if (hips[i].index >= starCount || (i > 0 && hips[i].hip < hips[i - 1].hip)) return false;
+        return true;
+    }
+
+    MappedFile file;
+    const CatalogStar* stars = nullptr;
+    const CatalogHipEntry* hipIndex = nullptr;
+    const uint32_t* cellStart = nullptr;
+    size_t count = 0, hipCount = 0;
+    int depth = 0;
+    SkyIndex<CatalogStar> index;
+};
+
+// ----------------------
+// B-V colour index -> display RGB
+// ----------------------
+// Ballesteros (2012) for temperature, then a blackbody RGB fit.
+inline void starColorFromBV(float bv, float rgb[3]) {
+    if (!(bv > -0.4f)) bv = -0.4f;   // also catches NaN (missing ci)
+    if (bv > 2.0f) bv = 2.0f;
+    float t = 4600.0f * (1.0f / (0.92f * bv + 1.7f) + 1.0f / (0.92f * bv + 0.62f)) / 100.0f;
+
+    float r, g, b;
+    if (t <= 66.0f) {
+        r = 255.0f;
+        g = 99.4708f * std::log(t) - 161.1196f;
+        b = t <= 19.0f ? 0.0f : 138.5177f * std::log(t - 10.0f) - 305.0448f;
+    } else {
+        r = 329.6987f * std::pow(t - 60.0f, -0.1332f);
+        g = 288.1222f * std::pow(t - 60.0f, -0.0755f);
+        b = 255.0f;
+    }
+    rgb[0] = std::min(std::max(r / 255.0f, 0.0f), 1.0f);
+    rgb[1] = std::min(std::max(g / 255.0f, 0.0f), 1.0f);
+    rgb[2] = std::min(std::max(b / 255.0f, 0.0f), 1.0f);
+}
+
+// ----------------------
+// CSV import (offline, run once)
+// ----------------------
+inline void splitCsvLine(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string cur;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (c == '"') {
+            if (quoted && i + 1 < line.size() && line[i + 1] == '"') { cur += '"'; i++; }
+            else quoted = !quoted;
+        } else if (c == ',' && !quoted) {
+            fields.push_back(cur);
+            cur.clear();
+        } else if (c != '\r') {
+            cur += c;
+        }
+    }
+    fields.push_back(cur);
+}
+
+inline int findCsvColumn(const std::vector<std::string>& header,
+                         std::initializer_list<const char*> names) {
+    for (const char* name : names) {
+        for (size_t i = 0; i < header.size(); i++) {
+            std::string h = header[i];
+            for (char& c : h) c = (char)std::tolower((unsigned char)c);
+            if (h == name) return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Converts csvPath into the binary catalog at binPath. Recognised columns:
+//   position   rarad/decrad, ra (hours) + dec (degrees), or radeg/dedeg
+//   magnitude  mag, vmag, hpmag
+//   colour     ci, b-v, bv         (optional)
+//   id         hip                 (optional)
+inline bool importStarCatalog(const char* csvPath, const char* binPath) {
+    std::ifstream in(csvPath);
+    if (!in) {
+        std::cerr << "ERR: cannot open " << csvPath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    std::vector<std::string> header, fields;
+    if (!std::getline(in, line)) return false;
+    splitCsvLine(line, header);
+
+    double raScale = 1.0, decScale = 1.0;   // -> radians
+    int raCol = findCsvColumn(header, {"rarad"});
+    int decCol = findCsvColumn(header, {"decrad"});
+    if (raCol < 0 || decCol < 0) {
+        raCol = findCsvColumn(header, {"ra"});
+        decCol = findCsvColumn(header, {"dec"});
+        raScale = kCatalogPi / 12.0;      // HYG: RA in hours
+        decScale = kCatalogPi / 180.0;
+    }
+    if (raCol < 0 || decCol < 0) {
+        raCol = findCsvColumn(header, {"radeg", "ra_deg", "raicrs"});
+        decCol = findCsvColumn(header, {"dedeg", "decdeg", "dec_deg", "deicrs"});
+        raScale = decScale = kCatalogPi / 180.0;
+    }
+    int magCol = findCsvColumn(header, {"mag", "vmag", "hpmag"});
+    int ciCol = findCsvColumn(header, {"ci", "b-v", "bv"});
+    int hipCol = findCsvColumn(header, {"hip"});
+    if (raCol < 0 || decCol < 0 || magCol < 0) {
+        std::cerr << "ERR: " << csvPath << " needs RA, Dec and magnitude columns" << std::endl;
+        return false;
+    }
+
+    std::vector<CatalogStar> stars;
+    size_t skipped = 0;
+    while (std::getline(in, line)) {
+        splitCsvLine(line, fields);
+        int needed = std::max(std::max(raCol, decCol), magCol);
+        if ((int)fields.size() <= needed || fields[magCol].empty() || fields[raCol].empty()) {
+            skipped++;
+            continue;
+        }
+        double ra = std::atof(fields[raCol].c_str()) * raScale;
+        double dec = std::atof(fields[decCol].c_str()) * decScale;
+        float mag = (float)std::atof(fields[magCol].c_str());
+        if (mag < -5.0f) { skipped++; continue; }   // the Sun row in HYG
+
+        CatalogStar s;
+        s.dir[0] = (float)(std::cos(dec) * std::cos(ra));
+        s.dir[1] = (float)(std::cos(dec) * std::sin(ra));
+        s.dir[2] = (float)std::sin(dec);
+        s.mag = mag;
+        s.ci = (ciCol >= 0 && ciCol < (int)fields.size() && !fields[ciCol].empty())
+                   ? (float)std::atof(fields[ciCol].c_str()) : NAN;
+        s.hip = (hipCol >= 0 && hipCol < (int)fields.size())
+                    ? (uint32_t)std::strtoul(fields[hipCol].c_str(), nullptr, 10) : 0;
+        stars.push_back(s);
+    }
+
+    std::vector<uint32_t> cellStart;
+    buildSkyIndex(stars, kSkyIndexDepth, cellStart);
+
+    std::vector<CatalogHipEntry> hips;
+    for (size_t i = 0; i < stars.size(); i++) {
+        if (stars[i].hip) {
+            CatalogHipEntry e = {stars[i].hip, (uint32_t)i};
+            hips.push_back(e);
+        }
+    }
+    std::sort(hips.begin(), hips.end(),
+        [](const CatalogHipEntry& a, const CatalogHipEntry& b) { return a.hip < b.hip; });
+
+    CatalogHeader h;
+    std::memcpy(h.magic, kCatalogMagic, sizeof(kCatalogMagic));
+    h.version = kCatalogVersion;
+    h.byteOrder = kCatalogByteOrder;
+    h.starCount = (uint32_t)stars.size();
+    h.hipCount = (uint32_t)hips.size();
+    h.indexDepth = kSkyIndexDepth;
+    h.starOffset = sizeof(CatalogHeader);
+    h.cellOffset = h.starOffset + h.starCount * (uint32_t)sizeof(CatalogStar);
+    h.hipOffset = h.cellOffset + (uint32_t)(cellStart.size() * sizeof(uint32_t));
+
+    FILE* out = std::fopen(binPath, "wb");
+    if (!out) {
+        std::cerr << "ERR: cannot write " << binPath << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(&h, sizeof(h), 1, out) == 1 &&
+              std::fwrite(stars.data(), sizeof(CatalogStar), stars.size(), out) == stars.size() &&
+              std::fwrite(cellStart.data(), sizeof(uint32_t), cellStart.size(), out) == cellStart.size() &&
+              std::fwrite(hips.data(), sizeof(CatalogHipEntry), hips.size(), out) == hips.size();
+    if (std::fclose(out) != 0 || !ok) {
+        // A truncated catalog would only be rejected on the next start
+        std::cerr << "ERR: failed writing " << binPath << std::endl;
+        std::remove(binPath);
+        return false;
+    }
+
+    std::cout << "Imported " << stars.size() << " stars (" << skipped << " rows skipped, "
+              << hips.size() << " with HIP ids) -> " << binPath << std::endl;
+    return true;
+}
+
+#endif
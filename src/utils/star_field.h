@@ -0,0 +1,105 @@
+// ======================
+// Procedural Star Field
+// ======================
+// Background and Milky Way stars generated once from a seeded PRNG into a
+// structure-of-arrays buffer. The same seed always gives the same sky, so the
+// field no longer flickers between redraws, and it is only regenerated when
+// the star count changes.
+
+#ifndef COSMIC_STAR_FIELD_H
+#define COSMIC_STAR_FIELD_H
+
+#include <cstdint>
+#include <vector>
+
+// ----------------------
+// xorshift64* - small, fast and plenty for scattering points
+// ----------------------
+class StarRng {
+public:
+    explicit StarRng(uint64_t seed) {
+        // splitmix64 step so nearby seeds give unrelated streams (state must be != 0)
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1;
+    }
+
+    uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return (uint32_t)((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+
+    // Uniform in [0, 1)
+    float nextFloat() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    // Uniform in [lo, hi)
+    float range(float lo, float hi) { return lo + (hi - lo) * nextFloat(); }
+
+private:
+    uint64_t state;
+};
+
+// ----------------------
+// Structure-of-arrays star storage
+// ----------------------
+struct StarField {
+    std::vector<float> x, y, z;
+    std::vector<float> brightness;       // 0..1
+    std::vector<uint32_t> tint;          // 0xAABBGGRR, multiplied by brightness
+    size_t backgroundCount = 0;          // [0, backgroundCount) background stars
+    size_t milkyWayCount = 0;            // then the Milky Way band
+
+    size_t size() const { return x.size(); }
+
+    void clear() {
+        x.clear(); y.clear(); z.clear();
+        brightness.clear(); tint.clear();
+        backgroundCount = milkyWayCount = 0;
+    }
+
+    void reserve(size_t n) {
+        x.reserve(n); y.reserve(n); z.reserve(n);
+        brightness.reserve(n); tint.reserve(n);
+    }
+
+    void add(float px, float py, float pz, float b, uint32_t t) {
+        x.push_back(px); y.push_back(py); z.push_back(pz);
+        brightness.push_back(b); tint.push_back(t);
+    }
+};
+
+inline uint32_t packTint(float r, float g, float b) {
+    return 0xFF000000u | ((uint32_t)(b * 255.0f + 0.5f) << 16) |
+           ((uint32_t)(g * 255.0f + 0.5f) << 8) | (uint32_t)(r * 255.0f + 0.5f);
+}
+
+// Same distribution the scene always used: background stars scattered over
+// the central 100x100 floor area, Milky Way stars jittered along the diagonal.
+inline void generateStarField(StarField& field, uint64_t seed,
+                              size_t backgroundStars, size_t milkyWayStars) {
+    field.clear();
+    field.reserve(backgroundStars + milkyWayStars);
+    StarRng rng(seed);
+
+    const uint32_t backgroundTint = packTint(1.0f, 1.0f, 0.98f);
+    for (size_t i = 0; i < backgroundStars; i++) {
+        float x = rng.range(-50.0f, 50.0f);
+        float z = rng.range(-50.0f, 50.0f);
+        field.add(x, 0.1f, z, rng.range(0.6f, 0.85f), backgroundTint);
+    }
+    field.backgroundCount = backgroundStars;
+
+    const uint32_t milkyWayTint = packTint(1.0f, 0.98f, 0.96f);
+    for (size_t i = 0; i < milkyWayStars; i++) {
+        float t = (float)i / (float)milkyWayStars;
+        float x = -45 + t * 90 + rng.range(-10.0f, 10.0f);
+        float z = -45 + t * 90 + rng.range(-10.0f, 10.0f);
+        field.add(x, 0.1f, z, rng.range(0.75f, 1.0f), milkyWayTint);
+    }
+    field.milkyWayCount = milkyWayStars;
+}
+
+#endif
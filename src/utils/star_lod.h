@@ -0,0 +1,68 @@
+// ======================
+// Star Level of Detail
+// ======================
+// Picks the limiting magnitude for catalog stars each frame:
+//   - the field of view sets the target (narrower view = deeper sky, the
+//     usual 5 log10(magnification) gain of a telescope),
+//   - the limit eases toward the target so faint stars fade in instead of
+//     popping as the camera zooms,
+//   - a frame-time controller sizes the star budget that SkyIndex::query
+//     enforces per view, so wide shots cannot blow the frame.
+
+#ifndef COSMIC_STAR_LOD_H
+#define COSMIC_STAR_LOD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+struct StarLodSettings {
+    float wideMagnitude = 6.5f;     // limit at referenceFov (naked eye)
+    float referenceFov = 60.0f;     // degrees
+    float faintest = 99.0f;         // catalog depth; the limit never goes past it
+    float fadeWidth = 1.0f;         // magnitudes over which stars fade in
+    float easeRate = 4.0f;          // 1/s, how fast the limit follows the target
+    float frameBudgetMs = 14.0f;    // whole-frame render time the budget aims for
+    size_t minStars = 20000;
+    size_t maxStars = 2000000;
+};
+
+class StarLod {
+public:
+    StarLodSettings settings;
+
+    // Call once per rendered frame. frameMs is the previous frame's render
+    // time, dtSeconds the time since the previous update.
+    void update(float fovDegrees, float frameMs, float dtSeconds) {
+        target = settings.wideMagnitude +
+                 5.0f * std::log10(settings.referenceFov / std::max(fovDegrees, 0.01f));
+        target = std::min(target, settings.faintest + settings.fadeWidth);
+
+        if (limit < -50.0f) {
+            limit = target;   // first frame: no fade from nothing
+        } else {
+            float k = std::min(1.0f, settings.easeRate * std::max(dtSeconds, 0.0f));
+            limit += (target - limit) * k;
+            if (std::fabs(target - limit) < 0.01f) limit = target;
+        }
+
+        // Multiplicative decrease when over budget, slow growth with clear headroom
+        if (frameMs > settings.frameBudgetMs)
+            budget = (size_t)(budget * 0.8);
+        else if (frameMs < settings.frameBudgetMs * 0.6f)
+            budget = (size_t)(budget * 1.05) + 1;
+        budget = std::max(settings.minStars, std::min(settings.maxStars, budget));
+    }
+
+    float magnitudeLimit() const { return limit; }
+    float targetLimit() const { return target; }
+    size_t starBudget() const { return budget; }
+    bool settled() const { return limit == target; }
+
+private:
+    float limit = -99.0f;
+    float target = 6.5f;
+    size_t budget = 200000;
+};
+
+#endif
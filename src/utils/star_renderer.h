@@ -0,0 +1,302 @@
+// ======================
+// Point-Sprite Star Renderer
+// ======================
+// Draws an entire star set (StarBuffer) with one glDrawArrays. Each star is a 12-byte
+// vertex (int16 position, magnitude, twinkle phase, RGBA8 colour); size,
+// Gaussian falloff and twinkle are computed in src/shaders/*.glsl and stars
+// are blended additively. Needs GL 2.0 shaders plus buffer objects - callers
+// check ready() and keep their fixed-function path otherwise.
+
+#ifndef COSMIC_STAR_RENDERER_H
+#define COSMIC_STAR_RENDERER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gl_ext.h"
+#include "star_catalog.h"
+#include "star_field.h"
+
+// ----------------------
+// Packed vertex - 12 bytes
+// ----------------------
+struct StarVertex {
+    int16_t x, y, z;    // position / positionScale
+    uint8_t mag;        // (magnitude + 2) * 10, so -2.0 .. +23.5
+    uint8_t phase;      // twinkle phase
+    uint8_t r, g, b, a; // colour
+};
+
+inline uint8_t encodeStarMagnitude(float mag) {
+    float v = (mag + 2.0f) * 10.0f + 0.5f;
+    if (v < 0.0f) v = 0.0f;
+    if (v > 255.0f) v = 255.0f;
+    return (uint8_t)v;
+}
+
+inline float decodeStarMagnitude(uint8_t m) { return m * 0.1f - 2.0f; }
+
+// Cheap per-star hash for the twinkle phase, stable across regenerations
+inline uint8_t starPhase(uint32_t i) {
+    i ^= i >> 16; i *= 0x7FEB352Du; i ^= i >> 15;
+    return (uint8_t)(i >> 24);
+}
+
+struct StarRenderSettings {
+    float pointScale = 2.0f;          // pixels across for a star at referenceMagnitude
+    float referenceMagnitude = 0.0f;  // stars this bright or brighter get full intensity
+    float brightness = 1.0f;
+    float twinkleAmount = 0.25f;
+    float magnitudeLimit = 99.0f;     // stars fainter than this are invisible
+    float fadeWidth = 0.0f;           // ...and fade in over this many magnitudes
+};
+
+// ----------------------
+// One uploaded star set
+// ----------------------
+class StarBuffer {
+public:
+    ~StarBuffer() { release(); }
+
+    // Replace the GPU star set. scale converts int16 positions back to world units.
+    void upload(const std::vector<StarVertex>& stars, float scale) {
+        if (!glext::hasBuffers) return;
+        if (!vbo) glext::GenBuffers(1, &vbo);
+        glext::BindBuffer(GL_ARRAY_BUFFER, vbo);
+        glext::BufferData(GL_ARRAY_BUFFER, stars.size() * sizeof(StarVertex),
+                          stars.data(), GL_STATIC_DRAW);
+        glext::BindBuffer(GL_ARRAY_BUFFER, 0);
+        count = stars.size();
+        positionScale = scale;
+    }
+
+    void release() {
+        if (vbo) glext::DeleteBuffers(1, &vbo);
+        vbo = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+
+private:
+    friend class StarRenderer;
+    GLuint vbo = 0;
+    size_t count = 0;
+    float positionScale = 1.0f;
+};
+
+class StarRenderer {
+public:
+    ~StarRenderer() { release(); }
+
+    // Compile and link the star shaders. Returns false (and stays unusable)
+    // when shaders or buffer objects are missing or fail to build.
+    bool init(const char* vertexPath, const char* fragmentPath) {
+        release();
+        if (!glext::hasShaders || !glext::hasBuffers) return false;
+
+        std::string vsSource, fsSource;
+        if (!readFile(vertexPath, vsSource) || !readFile(fragmentPath, fsSource)) return false;
+
+        GLuint vs = compile(GL_VERTEX_SHADER, vsSource, vertexPath);
+        GLuint fs = compile(GL_FRAGMENT_SHADER, fsSource, fragmentPath);
+        if (!vs || !fs) {
+            if (vs) glext::DeleteShader(vs);
+            if (fs) glext::DeleteShader(fs);
+            return false;
+        }
+
+        program = glext::CreateProgram();
+        glext::AttachShader(program, vs);
+        glext::AttachShader(program, fs);
+        glext::LinkProgram(program);
+        glext::DeleteShader(vs);   // flagged; freed with the program
+        glext::DeleteShader(fs);
+
+        GLint linked = 0;
+        glext::GetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            char log[1024];
+            glext::GetProgramInfoLog(program, sizeof(log), nullptr, log);
+            std::cerr << "ERR: star shader link failed:\n" << log << std::endl;
+            release();
+            return false;
+        }
+
+        attribLoc = glext::GetAttribLocation(program, "starAttrib");
+        positionScaleLoc = glext::GetUniformLocation(program, "positionScale");
+        pointScaleLoc = glext::GetUniformLocation(program, "pointScale");
+        brightnessLoc = glext::GetUniformLocation(program, "brightness");
+        twinkleLoc = glext::GetUniformLocation(program, "twinkleAmount");
+        timeLoc = glext::GetUniformLocation(program, "time");
+        referenceLoc = glext::GetUniformLocation(program, "referenceMagnitude");
+        limitLoc = glext::GetUniformLocation(program, "magnitudeLimit");
+        fadeLoc = glext::GetUniformLocation(program, "fadeWidth");
+        return true;
+    }
+
+    bool ready() const { return program != 0; }
+
+    // Expects additive blending and point sprites to be enabled by the caller
+    // (the render queue does this for RS_ADDITIVE | RS_POINT_SPRITE items).
+    void draw(const StarBuffer& stars, const StarRenderSettings& settings,
+              float timeSeconds) const {
+        draw(stars, 0, stars.count, settings, timeSeconds);
+    }
+
+    // Draw stars [first, first + count) of the buffer
+    void draw(const StarBuffer& stars, size_t first, size_t count,
+              const StarRenderSettings& settings, float timeSeconds) const {
+        GLint f = (GLint)first;
+        GLsizei n = (GLsizei)count;
+        draw(stars, &f, &n, 1, settings, timeSeconds);
+    }
+
+    // Draw several ranges of the buffer (e.g. a SkyIndex query) in one call
+    void draw(const StarBuffer& stars, const GLint* firsts, const GLsizei* counts, int ranges,
+              const StarRenderSettings& settings, float timeSeconds) const {
+        if (!ready() || !stars.vbo || ranges == 0) return;
+        glext::UseProgram(program);
+        glext::Uniform1f(positionScaleLoc, stars.positionScale);
+        glext::Uniform1f(pointScaleLoc, settings.pointScale);
+        glext::Uniform1f(referenceLoc, settings.referenceMagnitude);
+        glext::Uniform1f(brightnessLoc, settings.brightness);
+        glext::Uniform1f(twinkleLoc, settings.twinkleAmount);
+        glext::Uniform1f(limitLoc, settings.magnitudeLimit);
+        glext::Uniform1f(fadeLoc, settings.fadeWidth);
+        glext::Uniform1f(timeLoc, timeSeconds);
+
+        const char* base = nullptr;
+        glext::BindBuffer(GL_ARRAY_BUFFER, stars.vbo);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(3, GL_SHORT, sizeof(StarVertex), base);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(StarVertex), base + 8);
+        if (attribLoc >= 0) {
+            glext::EnableVertexAttribArray(attribLoc);
+            glext::VertexAttribPointer(attribLoc, 2, GL_UNSIGNED_BYTE, GL_FALSE,
+                                       sizeof(StarVertex), base + 6);
+        }
+
+        if (glext::MultiDrawArrays) {
+            glext::MultiDrawArrays(GL_POINTS, firsts, counts, ranges);
+        } else {
+            for (int i = 0; i < ranges; i++) glDrawArrays(GL_POINTS, firsts[i], counts[i]);
+        }
+
+        if (attribLoc >= 0) glext::DisableVertexAttribArray(attribLoc);
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glext::BindBuffer(GL_ARRAY_BUFFER, 0);
+        glext::UseProgram(0);
+    }
+
+    void release() {
+        if (program) glext::DeleteProgram(program);
+        program = 0;
+    }
+
+private:
+    static bool readFile(const char* path, std::string& out) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cout << "WARN: shader not found: " << path << std::endl;
+            return false;
+        }
+        std::stringstream ss;
+        ss << in.rdbuf();
+        out = ss.str();
+        return true;
+    }
+
+    static GLuint compile(GLenum type, const std::string& source, const char* path) {
+        GLuint shader = glext::CreateShader(type);
+        const char* src = source.c_str();
+        glext::ShaderSource(shader, 1, &src, nullptr);
+        glext::CompileShader(shader);
+        GLint ok = 0;
+        glext::GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glext::GetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            std::cerr << "ERR: " << path << " failed to compile:\n" << log << std::endl;
+            glext::DeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    GLuint program = 0;
+    GLint attribLoc = -1;
+    GLint positionScaleLoc = -1, pointScaleLoc = -1, brightnessLoc = -1;
+    GLint twinkleLoc = -1, timeLoc = -1, referenceLoc = -1;
+    GLint limitLoc = -1, fadeLoc = -1;
+};
+
+// ----------------------
+// StarField -> packed vertices
+// ----------------------
+// Returns the scale to pass to StarBuffer::upload().
+inline float packStarField(const StarField& field, std::vector<StarVertex>& out) {
+    float extent = 1.0f;
+    for (size_t i = 0; i < field.size(); i++) {
+        extent = std::max(extent, std::fabs(field.x[i]));
+        extent = std::max(extent, std::fabs(field.y[i]));
+        extent = std::max(extent, std::fabs(field.z[i]));
+    }
+    float toShort = 32767.0f / extent;
+
+    out.resize(field.size());
+    for (size_t i = 0; i < field.size(); i++) {
+        StarVertex& v = out[i];
+        v.x = (int16_t)std::lround(field.x[i] * toShort);
+        v.y = (int16_t)std::lround(field.y[i] * toShort);
+        v.z = (int16_t)std::lround(field.z[i] * toShort);
+        // brightness is linear flux relative to a magnitude 0 star
+        v.mag = encodeStarMagnitude(-2.5f * std::log10(std::max(field.brightness[i], 1e-6f)));
+        v.phase = starPhase((uint32_t)i);
+        uint32_t t = field.tint[i];
+        v.r = (uint8_t)(t & 0xFF);
+        v.g = (uint8_t)((t >> 8) & 0xFF);
+        v.b = (uint8_t)((t >> 16) & 0xFF);
+        v.a = 255;
+    }
+    return extent / 32767.0f;
+}
+
+// ----------------------
+// Catalog -> packed vertices on the sky sphere
+// ----------------------
+// Equatorial coordinates are mapped so the celestial pole points up (+Y).
+// Keeps the catalog's cell order, so SkyIndex query ranges index the buffer
+// directly.
+inline float packCatalogStars(const StarCatalog& catalog, float radius,
+                              std::vector<StarVertex>& out) {
+    const float toShort = 32767.0f;
+    out.resize(catalog.size());
+    for (size_t i = 0; i < catalog.size(); i++) {
+        const CatalogStar& s = catalog[i];
+        StarVertex& v = out[i];
+        float p[3];
+        skycell::toScene(s.dir, p);
+        v.x = (int16_t)std::lround(p[0] * toShort);
+        v.y = (int16_t)std::lround(p[1] * toShort);
+        v.z = (int16_t)std::lround(p[2] * toShort);
+        v.mag = encodeStarMagnitude(s.mag);
+        v.phase = starPhase((uint32_t)i);
+        float rgb[3];
+        starColorFromBV(s.ci, rgb);
+        v.r = (uint8_t)(rgb[0] * 255.0f + 0.5f);
+        v.g = (uint8_t)(rgb[1] * 255.0f + 0.5f);
+        v.b = (uint8_t)(rgb[2] * 255.0f + 0.5f);
+        v.a = 255;
+    }
+    return radius / toShort;
+}
+
+#endif
@@ -0,0 +1,149 @@
+// ======================
+// Trace Recorder
+// ======================
+// Timelines for chrome://tracing and ui.perfetto.dev (Chrome Trace Event
+// JSON): start-up phases, frame stages, swaps and worker threads.
+//   - Each thread records into its own fixed ring of events, so recording
+//     takes no lock; when a ring fills, its oldest events are overwritten.
+//   - A thread claims a ring from a lock-free list the first time it records
+//     and hands it back when it exits, so the soft rasteriser's per-frame
+//     workers reuse the same few rings (and timeline rows).
+//   - While recording is off, a TraceScope costs one relaxed atomic load.
+// Event names must outlive the recorder (string literals); writeJson()
+// should run between frames, when no other thread is recording.
+
+#ifndef COSMIC_TRACE_RECORDER_H
+#define COSMIC_TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+class TraceRecorder {
+public:
+    typedef std::chrono::steady_clock Clock;
+    static const size_t kRingSize = 1 << 14;   // events per thread
+
+    bool enabled() const { return recording.load(std::memory_order_relaxed); }
+
+    // Starting drops what earlier recordings left in the rings
+    void start() {
+        for (Ring* r = rings.load(std::memory_order_acquire); r; r = r->next)
+            r->head.store(0, std::memory_order_relaxed);
+        recording.store(true, std::memory_order_release);
+    }
+    void stop() { recording.store(false, std::memory_order_release); }
+
+    // A finished span on the calling thread
+    void complete(const char* name, const char* category, Clock::time_point begin, Clock::time_point end) {
+        if (!enabled()) return;
+        Ring* r = threadRing();
+        uint64_t n = r->head.load(std::memory_order_relaxed);
+        Event& e = r->events[n % kRingSize];
+        e.name = name;
+        e.category = category;
+        e.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch).count();
+        e.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        r->head.store(n + 1, std::memory_order_release);
+    }
+
+    // Label for the calling thread's timeline row
+    void nameThread(const char* name) {
+        if (enabled()) threadRing()->threadName = name;
+    }
+
+    bool writeJson(const char* path) const {
+        FILE* f = std::fopen(path, "w");
+        if (!f) return false;
+        std::fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        bool first = true;
+        for (Ring* r = rings.load(std::memory_order_acquire); r; r = r->next) {
+            std::fprintf(f, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                            "\"args\": {\"name\": \"%s\"}}",
+                         first ? "" : ",\n", r->tid, r->threadName ? r->threadName : "thread");
+            first = false;
+            uint64_t n = r->head.load(std::memory_order_acquire);
+            for (uint64_t i = n > kRingSize ? n - kRingSize : 0; i < n; i++) {
+                const Event& e = r->events[i % kRingSize];
+                std::fprintf(f, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                                "\"ts\": %.3f, \"dur\": %.3f}",
+                             e.name, e.category, r->tid, e.startNs / 1000.0, e.durationNs / 1000.0);
+            }
+        }
+        std::fprintf(f, "\n]}\n");
+        return std::fclose(f) == 0;
+    }
+
+private:
+    struct Event {
+        const char* name;
+        const char* category;
+        int64_t startNs, durationNs;   // from the recorder's epoch
+    };
+
+    struct Ring {
+        Event events[kRingSize];
+        std::atomic<uint64_t> head{0};      // events ever written; only the owner writes
+        std::atomic<bool> claimed{true};
+        const char* threadName = nullptr;
+        int tid = 0;
+        Ring* next = nullptr;
+    };
+
+    // Hands the ring back when its thread exits
+    struct ThreadSlot {
+        Ring* ring = nullptr;
+        ~ThreadSlot() {
+            if (ring) ring->claimed.store(false, std::memory_order_release);
+        }
+    };
+
+    Ring* threadRing() {
+        static thread_local ThreadSlot slot;
+        if (slot.ring) return slot.ring;
+        // A ring some finished thread gave back, else a new one
+        for (Ring* r = rings.load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if (r->claimed.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return slot.ring = r;
+        }
+        Ring* r = new Ring;
+        r->tid = ringCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        r->next = rings.load(std::memory_order_relaxed);
+        while (!rings.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return slot.ring = r;
+    }
+
+    // Rings live as long as the process: threads may still hold them at exit
+    std::atomic<Ring*> rings{nullptr};
+    std::atomic<int> ringCount{0};
+    std::atomic<bool> recording{false};
+    Clock::time_point epoch = Clock::now();
+};
+
+inline TraceRecorder& traceRecorder() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+// Records the enclosing block as one span
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* category = "cosmic")
+        : name(name), category(category), active(traceRecorder().enabled()) {
+        if (active) begin = TraceRecorder::Clock::now();
+    }
+    ~TraceScope() {
+        if (active) traceRecorder().complete(name, category, begin, TraceRecorder::Clock::now());
+    }
+
+private:
+    const char* name;
+    const char* category;
+    bool active;
+    TraceRecorder::Clock::time_point begin;
+};
+
+#endif
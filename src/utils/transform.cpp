@@ -0,0 +1,303 @@
+// ======================
+// Transform Math - matrix products, inverses and batch kernels
+// ======================
+
+#include "transform.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define COSMIC_TRANSFORM_SSE 1
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+static const float kDegToRad = 3.14159265358979f / 180.0f;
+
+// ----------------------
+// Builders
+// ----------------------
+Mat4 Mat4::identity() {
+    Mat4 r = {{1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1}};
+    return r;
+}
+
+Mat4 Mat4::translation(const Vec3& t) {
+    Mat4 r = identity();
+    r.m[12] = t.x;
+    r.m[13] = t.y;
+    r.m[14] = t.z;
+    return r;
+}
+
+Mat4 Mat4::scaling(const Vec3& s) {
+    Mat4 r = identity();
+    r.m[0] = s.x;
+    r.m[5] = s.y;
+    r.m[10] = s.z;
+    return r;
+}
+
+Mat4 Mat4::rotation(float degrees, const Vec3& axis) {
+    Vec3 a = normalize(axis);
+    float c = std::cos(degrees * kDegToRad), s = std::sin(degrees * kDegToRad), t = 1.0f - c;
+    Mat4 r = {{a.x * a.x * t + c,       a.y * a.x * t + a.z * s, a.x * a.z * t - a.y * s, 0,
+               a.x * a.y * t - a.z * s, a.y * a.y * t + c,       a.y * a.z * t + a.x * s, 0,
+               a.x * a.z * t + a.y * s, a.y * a.z * t - a.x * s, a.z * a.z * t + c,       0,
+               0, 0, 0, 1}};
+    return r;
+}
+
+Mat4 Mat4::fromArray(const float a[16]) {
+    Mat4 r;
+    std::memcpy(r.m, a, sizeof(r.m));
+    return r;
+}
+
+Mat4 lookAt(const Vec3& eye, const Vec3& centre, const Vec3& up) {
+    Vec3 f = normalize(centre - eye);
+    Vec3 s = normalize(cross(f, up));
+    Vec3 u = cross(s, f);
+    Mat4 r = {{s.x, u.x, -f.x, 0,
+               s.y, u.y, -f.y, 0,
+               s.z, u.z, -f.z, 0,
+               -dot(s, eye), -dot(u, eye), dot(f, eye), 1}};
+    return r;
+}
+
+Mat4 perspective(float fovYDegrees, float aspect, float zNear, float zFar) {
+    float f = 1.0f / std::tan(fovYDegrees * kDegToRad * 0.5f);
+    Mat4 r = {{f / aspect, 0, 0, 0,
+               0, f, 0, 0,
+               0, 0, (zFar + zNear) / (zNear - zFar), -1,
+               0, 0, 2.0f * zFar * zNear / (zNear - zFar), 0}};
+    return r;
+}
+
+// ----------------------
+// Products
+// ----------------------
+Mat4 Mat4::operator*(const Mat4& o) const {
+    Mat4 r;
+#ifdef COSMIC_TRANSFORM_SSE
+    __m128 c0 = _mm_load_ps(m), c1 = _mm_load_ps(m + 4), c2 = _mm_load_ps(m + 8), c3 = _mm_load_ps(m + 12);
+    for (int c = 0; c < 4; c++) {
+        const float* b = o.m + c * 4;
+        __m128 col = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(b[0])), _mm_mul_ps(c1, _mm_set1_ps(b[1]))),
+                                _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(b[2])), _mm_mul_ps(c3, _mm_set1_ps(b[3]))));
+        _mm_store_ps(r.m + c * 4, col);
+    }
+#else
+    for (int c = 0; c < 4; c++)
+        for (int row = 0; row < 4; row++)
+            r.m[c * 4 + row] = m[row] * o.m[c * 4] + m[4 + row] * o.m[c * 4 + 1] +
+                               m[8 + row] * o.m[c * 4 + 2] + m[12 + row] * o.m[c * 4 + 3];
+#endif
+    return r;
+}
+
+Vec4 Mat4::operator*(const Vec4& v) const {
+    Vec4 r;
+#ifdef COSMIC_TRANSFORM_SSE
+    __m128 out = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(m), _mm_set1_ps(v.x)),
+                                       _mm_mul_ps(_mm_load_ps(m + 4), _mm_set1_ps(v.y))),
+                            _mm_add_ps(_mm_mul_ps(_mm_load_ps(m + 8), _mm_set1_ps(v.z)),
+                                       _mm_mul_ps(_mm_load_ps(m + 12), _mm_set1_ps(v.w))));
+    _mm_store_ps(&r.x, out);
+#else
+    r.x = m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w;
+    r.y = m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w;
+    r.z = m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w;
+    r.w = m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w;
+#endif
+    return r;
+}
+
+Mat4 Mat4::transposed() const {
+    Mat4 r;
+    for (int c = 0; c < 4; c++)
+        for (int row = 0; row < 4; row++) r.m[row * 4 + c] = m[c * 4 + row];
+    return r;
+}
+
+// Cofactor expansion (as in GLU's __gluInvertMatrixd)
+Mat4 Mat4::inverse() const {
+    Mat4 inv;
+    float* o = inv.m;
+    o[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    o[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    o[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    o[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    o[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    o[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    o[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    o[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    o[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    o[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    o[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    o[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    o[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    o[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    o[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    o[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * o[0] + m[1] * o[4] + m[2] * o[8] + m[3] * o[12];
+    if (det == 0.0f) return identity();
+    float invDet = 1.0f / det;
+    for (int i = 0; i < 16; i++) o[i] *= invDet;
+    return inv;
+}
+
+Mat4 Mat4::normalMatrix() const {
+    const float a = m[0], b = m[4], c = m[8], d = m[1], e = m[5], f = m[9], g = m[2], h = m[6], i = m[10];
+    float det = a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+    float s = det != 0.0f ? 1.0f / det : 0.0f;
+    // Cofactor matrix / det, stored column-major
+    Mat4 r = {{(e * i - f * h) * s, -(b * i - c * h) * s, (b * f - c * e) * s, 0,
+               -(d * i - f * g) * s, (a * i - c * g) * s, -(a * f - c * d) * s, 0,
+               (d * h - e * g) * s, -(a * h - b * g) * s, (a * e - b * d) * s, 0,
+               0, 0, 0, 1}};
+    return r;
+}
+
+// ----------------------
+// Quaternions
+// ----------------------
+Quat Quat::fromAxisAngle(float degrees, const Vec3& axis) {
+    Vec3 a = normalize(axis);
+    float half = degrees * kDegToRad * 0.5f, s = std::sin(half);
+    return Quat{a.x * s, a.y * s, a.z * s, std::cos(half)};
+}
+
+Mat4 Quat::toMat4() const {
+    float xx = x * x, yy = y * y, zz = z * z, xy = x * y, xz = x * z, yz = y * z, wx = w * x, wy = w * y, wz = w * z;
+    Mat4 r = {{1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0,
+               2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0,
+               2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0,
+               0, 0, 0, 1}};
+    return r;
+}
+
+Quat slerp(const Quat& a, const Quat& b0, float t) {
+    Quat b = b0;
+    float cosTheta = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    if (cosTheta < 0.0f) {   // take the short way round
+        b = Quat{-b.x, -b.y, -b.z, -b.w};
+        cosTheta = -cosTheta;
+    }
+    float wa, wb;
+    if (cosTheta > 0.9995f) {   // nearly parallel: lerp avoids dividing by ~0
+        wa = 1.0f - t;
+        wb = t;
+    } else {
+        float theta = std::acos(cosTheta), s = 1.0f / std::sin(theta);
+        wa = std::sin((1.0f - t) * theta) * s;
+        wb = std::sin(t * theta) * s;
+    }
+    return Quat{a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb}.normalized();
+}
+
+// ----------------------
+// Batch kernels
+// ----------------------
+void transformPoints(const Mat4& mat, const Vec3* in, Vec4* out, size_t count) {
+#ifdef COSMIC_TRANSFORM_SSE
+    const float* m = mat.m;
+    __m128 c0 = _mm_load_ps(m), c1 = _mm_load_ps(m + 4), c2 = _mm_load_ps(m + 8), c3 = _mm_load_ps(m + 12);
+    for (size_t i = 0; i < count; i++) {
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(in[i].x)), _mm_mul_ps(c1, _mm_set1_ps(in[i].y))),
+                              _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(in[i].z)), c3));
+        _mm_store_ps(&out[i].x, r);
+    }
+#else
+    for (size_t i = 0; i < count; i++) out[i] = mat * Vec4{in[i].x, in[i].y, in[i].z, 1.0f};
+#endif
+}
+
+void transformPointsAffine(const Mat4& mat, const Vec3* in, Vec3* out, size_t count) {
+#ifdef COSMIC_TRANSFORM_SSE
+    const float* m = mat.m;
+    __m128 c0 = _mm_load_ps(m), c1 = _mm_load_ps(m + 4), c2 = _mm_load_ps(m + 8), c3 = _mm_load_ps(m + 12);
+    size_t i = 0;
+    // Every point but the last gets one 16-byte store; its fourth lane lands
+    // on out[i + 1].x, which the next point overwrites. Not when out overlaps
+    // in, where that lane could clobber an input not yet read.
+    if (in + count <= (const Vec3*)out || (const Vec3*)(out + count) <= in) {
+        for (; i + 1 < count; i++) {
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(in[i].x)), _mm_mul_ps(c1, _mm_set1_ps(in[i].y))),
+                                  _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(in[i].z)), c3));
+            _mm_storeu_ps(&out[i].x, r);
+        }
+    }
+    for (; i < count; i++) {
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(in[i].x)), _mm_mul_ps(c1, _mm_set1_ps(in[i].y))),
+                              _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(in[i].z)), c3));
+        _mm_storel_pi((__m64*)&out[i].x, r);
+        _mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
+    }
+#else
+    for (size_t i = 0; i < count; i++) out[i] = mat.transformPoint(in[i]);
+#endif
+}
+
+static inline void transformPointScalar(const float* m, const float* x, const float* y, const float* z, size_t i,
+                                        float* outX, float* outY, float* outZ, float* outW) {
+    if (outX) outX[i] = m[0] * x[i] + m[4] * y[i] + m[8] * z[i] + m[12];
+    if (outY) outY[i] = m[1] * x[i] + m[5] * y[i] + m[9] * z[i] + m[13];
+    if (outZ) outZ[i] = m[2] * x[i] + m[6] * y[i] + m[10] * z[i] + m[14];
+    if (outW) outW[i] = m[3] * x[i] + m[7] * y[i] + m[11] * z[i] + m[15];
+}
+
+#ifdef COSMIC_TRANSFORM_SSE
+// Output row r for four points; c holds the 16 matrix entries broadcast
+static inline __m128 matrixRow(const __m128* c, int r, __m128 x, __m128 y, __m128 z) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[r], x), _mm_mul_ps(c[4 + r], y)),
+                      _mm_add_ps(_mm_mul_ps(c[8 + r], z), c[12 + r]));
+}
+#endif
+#if defined(__AVX__)
+static inline __m256 matrixRow(const __m256* c, int r, __m256 x, __m256 y, __m256 z) {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c[r], x), _mm256_mul_ps(c[4 + r], y)),
+                         _mm256_add_ps(_mm256_mul_ps(c[8 + r], z), c[12 + r]));
+}
+#endif
+
+void transformPoints(const Mat4& mat, const float* x, const float* y, const float* z, size_t count,
+                     float* outX, float* outY, float* outZ, float* outW) {
+    // One pass: each x/y/z vector is loaded once and gives every wanted row.
+    // The null checks do not change inside the loop, so they predict perfectly.
+    const float* m = mat.m;
+    const float* firstOut = outX ? outX : outY ? outY : outZ ? outZ : outW;
+    if (!firstOut) return;
+    size_t i = 0;
+#if defined(__AVX__)
+    // Scalar points until the outputs are 32-byte aligned: a 256-bit store
+    // that splits a cache line costs more than the wider vector saves
+    for (; i < count && ((size_t)(firstOut + i) & 31); i++)
+        transformPointScalar(m, x, y, z, i, outX, outY, outZ, outW);
+    __m256 a[16];
+    for (int k = 0; k < 16; k++) a[k] = _mm256_set1_ps(m[k]);
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+        if (outX) _mm256_storeu_ps(outX + i, matrixRow(a, 0, vx, vy, vz));
+        if (outY) _mm256_storeu_ps(outY + i, matrixRow(a, 1, vx, vy, vz));
+        if (outZ) _mm256_storeu_ps(outZ + i, matrixRow(a, 2, vx, vy, vz));
+        if (outW) _mm256_storeu_ps(outW + i, matrixRow(a, 3, vx, vy, vz));
+    }
+#endif
+#ifdef COSMIC_TRANSFORM_SSE
+    __m128 b[16];
+    for (int k = 0; k < 16; k++) b[k] = _mm_set1_ps(m[k]);
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        if (outX) _mm_storeu_ps(outX + i, matrixRow(b, 0, vx, vy, vz));
+        if (outY) _mm_storeu_ps(outY + i, matrixRow(b, 1, vx, vy, vz));
+        if (outZ) _mm_storeu_ps(outZ + i, matrixRow(b, 2, vx, vy, vz));
+        if (outW) _mm_storeu_ps(outW + i, matrixRow(b, 3, vx, vy, vz));
+    }
+#endif
+    for (; i < count; i++) transformPointScalar(m, x, y, z, i, outX, outY, outZ, outW);
+}
@@ -0,0 +1,143 @@
+// ======================
+// Transform Math
+// ======================
+// CPU-side vectors, matrices and quaternions, so culling, picking and star
+// work need not round-trip through the GL matrix stack. Matrices are
+// column-major like OpenGL, so Mat4::data() can go straight to
+// glLoadMatrixf / glMultMatrixf. The builders match their GL/GLU
+// counterparts: translation / rotation / scaling = glTranslatef /
+// glRotatef (degrees) / glScalef, lookAt = gluLookAt, perspective =
+// gluPerspective.
+//
+// Small vector operations are inline here. Matrix products, inverses and
+// the batch kernels live in transform.cpp and use SSE (AVX for the SoA
+// kernel when built with -mavx), with a scalar fallback. For bulk work
+// prefer the SoA kernel: it reads each coordinate once and beats a plain
+// loop while the batch fits in cache. The Vec3/Vec4 kernels only match a
+// loop the compiler vectorises itself, and past the caches all of them
+// are bound by memory bandwidth (see --bench-transform).
+
+#ifndef COSMIC_TRANSFORM_H
+#define COSMIC_TRANSFORM_H
+
+#include <cmath>
+#include <cstddef>
+
+struct Vec3 {
+    float x, y, z;
+
+    Vec3 operator+(const Vec3& o) const { return Vec3{x + o.x, y + o.y, z + o.z}; }
+    Vec3 operator-(const Vec3& o) const { return Vec3{x - o.x, y - o.y, z - o.z}; }
+    Vec3 operator-() const { return Vec3{-x, -y, -z}; }
+    Vec3 operator*(float s) const { return Vec3{x * s, y * s, z * s}; }
+    Vec3& operator+=(const Vec3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+    Vec3& operator-=(const Vec3& o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+};
+
+inline float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return Vec3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+inline float length(const Vec3& v) { return std::sqrt(dot(v, v)); }
+inline Vec3 normalize(const Vec3& v) {
+    float l = length(v);
+    return l > 0.0f ? v * (1.0f / l) : v;
+}
+
+struct alignas(16) Vec4 {
+    float x, y, z, w;
+
+    Vec3 xyz() const { return Vec3{x, y, z}; }
+    // Perspective divide (clip space to NDC)
+    Vec3 project() const { return Vec3{x / w, y / w, z / w}; }
+};
+
+inline float dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+// ----------------------
+// 4x4 matrix, column-major
+// ----------------------
+struct alignas(16) Mat4 {
+    float m[16];   // m[column * 4 + row]
+
+    static Mat4 identity();
+    static Mat4 translation(const Vec3& t);
+    static Mat4 scaling(const Vec3& s);
+    static Mat4 rotation(float degrees, const Vec3& axis);   // glRotatef
+    static Mat4 fromArray(const float a[16]);
+
+    const float* data() const { return m; }
+    float& at(int row, int column) { return m[column * 4 + row]; }
+    float at(int row, int column) const { return m[column * 4 + row]; }
+    Vec4 column(int c) const { return Vec4{m[c * 4], m[c * 4 + 1], m[c * 4 + 2], m[c * 4 + 3]}; }
+    Vec4 row(int r) const { return Vec4{m[r], m[4 + r], m[8 + r], m[12 + r]}; }
+
+    Mat4 operator*(const Mat4& o) const;
+    Vec4 operator*(const Vec4& v) const;
+
+    // (x, y, z, 1) / (x, y, z, 0) through the upper rows, no divide
+    Vec3 transformPoint(const Vec3& p) const {
+        return Vec3{m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+                    m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+                    m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]};
+    }
+    Vec3 transformDirection(const Vec3& d) const {
+        return Vec3{m[0] * d.x + m[4] * d.y + m[8] * d.z,
+                    m[1] * d.x + m[5] * d.y + m[9] * d.z,
+                    m[2] * d.x + m[6] * d.y + m[10] * d.z};
+    }
+
+    Mat4 transposed() const;
+    Mat4 inverse() const;          // general; identity if singular
+    Mat4 normalMatrix() const;     // inverse transpose of the upper 3x3, unnormalised like GL
+};
+
+// gluLookAt(eye, centre, up)
+Mat4 lookAt(const Vec3& eye, const Vec3& centre, const Vec3& up);
+// gluPerspective(fovY in degrees, aspect, zNear, zFar)
+Mat4 perspective(float fovYDegrees, float aspect, float zNear, float zFar);
+
+// ----------------------
+// Quaternion (x, y, z, w), unit length for rotations
+// ----------------------
+struct alignas(16) Quat {
+    float x, y, z, w;
+
+    static Quat identity() { return Quat{0, 0, 0, 1}; }
+    static Quat fromAxisAngle(float degrees, const Vec3& axis);
+
+    Quat operator*(const Quat& o) const {
+        return Quat{w * o.x + x * o.w + y * o.z - z * o.y,
+                    w * o.y - x * o.z + y * o.w + z * o.x,
+                    w * o.z + x * o.y - y * o.x + z * o.w,
+                    w * o.w - x * o.x - y * o.y - z * o.z};
+    }
+    Quat conjugate() const { return Quat{-x, -y, -z, w}; }
+    Quat normalized() const {
+        float l = std::sqrt(x * x + y * y + z * z + w * w);
+        return l > 0.0f ? Quat{x / l, y / l, z / l, w / l} : identity();
+    }
+
+    Vec3 rotate(const Vec3& v) const {
+        // v + 2w (q x v) + 2 q x (q x v)
+        Vec3 q{x, y, z};
+        Vec3 t = cross(q, v) * 2.0f;
+        return v + t * w + cross(q, t);
+    }
+    Mat4 toMat4() const;
+};
+
+Quat slerp(const Quat& a, const Quat& b, float t);
+
+// ----------------------
+// Batch kernels: N points through one matrix
+// ----------------------
+// (x, y, z, 1) -> clip space, array of structures
+void transformPoints(const Mat4& m, const Vec3* in, Vec4* out, size_t count);
+// (x, y, z, 1) -> (x, y, z), ignoring the bottom row (model / view transforms)
+void transformPointsAffine(const Mat4& m, const Vec3* in, Vec3* out, size_t count);
+// Structure of arrays; any of the outputs may be null when not needed
+void transformPoints(const Mat4& m, const float* x, const float* y, const float* z, size_t count,
+                     float* outX, float* outY, float* outZ, float* outW);
+
+#endif